@@ -279,6 +279,7 @@ endif
 clap       = $(TARGET_DIR)/$(CLAP_FILENAME)
 shared     = $(TARGET_DIR)/$(NAME)$(LIB_EXT)
 static     = $(TARGET_DIR)/$(NAME).a
+bench      = $(TARGET_DIR)/$(NAME)-bench$(APP_EXT)
 
 ifeq ($(MACOS),true)
 vst2files += $(TARGET_DIR)/$(VST2_CONTENTS)/Info.plist
@@ -592,6 +593,16 @@ endif
 	$(SILENT)rm -f $@
 	$(SILENT)$(AR) crs $@ $^
 
+# ---------------------------------------------------------------------------------------------------------------------
+# Offline benchmark
+
+bench: $(bench)
+
+$(bench): $(OBJS_DSP) $(BUILD_DIR)/DistrhoPluginMain_BENCH.cpp.o
+	-@mkdir -p $(shell dirname $@)
+	@echo "Creating benchmark for $(NAME)"
+	$(SILENT)$(CXX) $^ $(BUILD_CXX_FLAGS) $(LINK_FLAGS) $(EXTRA_LIBS) -o $@
+
 # ---------------------------------------------------------------------------------------------------------------------
 # macOS files
 
@@ -635,6 +646,7 @@ endif
 -include $(BUILD_DIR)/DistrhoPluginMain_CLAP.cpp.d
 -include $(BUILD_DIR)/DistrhoPluginMain_SHARED.cpp.d
 -include $(BUILD_DIR)/DistrhoPluginMain_STATIC.cpp.d
+-include $(BUILD_DIR)/DistrhoPluginMain_BENCH.cpp.d
 
 -include $(BUILD_DIR)/DistrhoUIMain_JACK.cpp.d
 -include $(BUILD_DIR)/DistrhoUIMain_DSSI.cpp.d
@@ -565,6 +565,16 @@ START_NAMESPACE_DISTRHO
  */
 #define DISTRHO_PLUGIN_WANT_MIDI_OUTPUT 1
 
+/**
+   Whether the plugin wants sample-accurate parameter changes.@n
+   When enabled, parameter changes that the host schedules inside a block are not applied before run(),
+   but passed to it as a list of events sorted by frame.@n
+   Only CLAP and VST3 provide such timing information, other formats keep applying changes at the start of the block.
+   @see Plugin::run(const float**, float**, uint32_t, const ParameterEvent*, uint32_t)
+   @see AudioParameterSyncHelper
+ */
+#define DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS 1
+
 /**
    Whether the plugin wants to change its own parameter inputs.@n
    Not all hosts or plugin formats support this,
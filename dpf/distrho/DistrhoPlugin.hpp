@@ -133,6 +133,24 @@ static const uint32_t kParameterIsOutput = 0x10;
 */
 static const uint32_t kParameterIsTrigger = 0x20 | kParameterIsBoolean;
 
+/**
+   Parameter value is smoothed by DPF.@n
+   When the value changes, DPF ramps towards it over Parameter::smoothTime
+   and provides a per-sample ramp during run(), see Plugin::getParameterRamp().@n
+   The ramp follows an exponential curve sampled once per block, and is linear within each block.@n
+   Ignored for output, boolean and integer parameters.
+*/
+static const uint32_t kParameterIsSmoothed = 0x40;
+
+/**
+   Parameter accepts non-destructive modulation from the host.@n
+   The modulation is an offset kept by DPF apart from the parameter value, so setParameterValue() is not called for it.
+   Use Plugin::getParameterModulatedValue() during run() to get the value to process with.@n
+   Ignored for output, boolean and integer parameters.
+   @note Only supported under CLAP. For other formats the modulation offset is always 0.
+*/
+static const uint32_t kParameterIsModulatable = 0x80;
+
 /** @} */
 
 /* ------------------------------------------------------------------------------------------------------------
@@ -621,6 +639,13 @@ struct Parameter {
     */
     uint32_t groupId;
 
+   /**
+      Time in milliseconds that a smoothed parameter takes to settle on a new value.@n
+      More precisely, the time constant of the ramp, after which ~63% of the change has been applied.
+      @note This value is only used if kParameterIsSmoothed is set in hints.
+    */
+    float smoothTime;
+
    /**
       Default constructor for a null parameter.
     */
@@ -634,7 +659,8 @@ struct Parameter {
           enumValues(),
           designation(kParameterDesignationNull),
           midiCC(0),
-          groupId(kPortGroupNone) {}
+          groupId(kPortGroupNone),
+          smoothTime(20.0f) {}
 
    /**
       Constructor using custom values.
@@ -649,7 +675,8 @@ struct Parameter {
           enumValues(),
           designation(kParameterDesignationNull),
           midiCC(0),
-          groupId(kPortGroupNone) {}
+          groupId(kPortGroupNone),
+          smoothTime(20.0f) {}
 
    /**
       Initialize a parameter for a specific designation.
@@ -798,6 +825,28 @@ struct MidiEvent {
     const uint8_t* dataExt;
 };
 
+/**
+   Parameter event.@n
+   A parameter change scheduled by the host to happen at a specific frame within the current block.
+   @see DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+ */
+struct ParameterEvent {
+   /**
+      Time offset in frames.
+    */
+    uint32_t frame;
+
+   /**
+      Parameter index.
+    */
+    uint32_t index;
+
+   /**
+      New parameter value.
+    */
+    float value;
+};
+
 /**
    Time position.@n
    The @a playing and @a frame values are always valid.@n
@@ -961,6 +1010,9 @@ struct TimePosition {
 
    The process function run() changes wherever DISTRHO_PLUGIN_WANT_MIDI_INPUT is enabled or not.@n
    When enabled it provides midi input events.
+
+   It also changes wherever DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS is enabled or not.@n
+   When enabled it provides sample-accurate parameter events.
  */
 class Plugin
 {
@@ -1031,6 +1083,39 @@ public:
     const TimePosition& getTimePosition() const noexcept;
 #endif
 
+   /**
+      Get the smoothed values of parameter @a index for the current run() call, one per frame.@n
+      Returns null if the parameter is not moving, in which case its current value applies to the whole block.
+      This function must only be called during run() and only for parameters with the kParameterIsSmoothed hint.
+      @note When the host runs more frames than the buffer size, parameters jump directly to their new value.
+      @see kParameterIsSmoothed
+    */
+    const float* getParameterRamp(uint32_t index) const noexcept;
+
+   /**
+      Get the modulated value of parameter @a index, that is @a value plus the current host modulation, within the parameter ranges.@n
+      @a value is typically the last value received in setParameterValue().
+      Returns @a value unchanged if the parameter is not being modulated.
+      Modulation changes apply to the whole run() call, starting at the block where they are received.
+      @see kParameterIsModulatable
+    */
+    float getParameterModulatedValue(uint32_t index, float value) const noexcept;
+
+   /**
+      Task function for parallelFor(), called once per @a index with the @a ptr given to parallelFor().
+    */
+    typedef void (*ParallelTaskFunc)(void* ptr, uint32_t index);
+
+   /**
+      Run @a task for each index from 0 to @a count - 1, possibly in parallel on the host realtime worker threads.@n
+      Returns once all tasks are done.
+      Tasks must be independent from each other and follow the same realtime rules as run().
+      This function must only be called during run(), and never from within a task.
+      @note Only CLAP hosts with the thread-pool extension run tasks in parallel,
+            otherwise they run serially in the calling thread.
+    */
+    void parallelFor(uint32_t count, ParallelTaskFunc task, void* ptr);
+
 #if DISTRHO_PLUGIN_WANT_LATENCY
    /**
       Change the plugin audio output latency to @a frames.@n
@@ -1235,7 +1320,30 @@ protected:
     */
     virtual void deactivate() {}
 
-#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+   /**
+      Run/process function for plugins with MIDI input and sample-accurate parameter events.
+      Parameter changes at the start of the block are applied through setParameterValue() before this call,
+      later ones are given as a list sorted by frame, which the plugin is then responsible for applying.
+      @note Some parameters might be null if there are no audio inputs/outputs, MIDI or parameter events.
+      @see AudioParameterSyncHelper
+    */
+    virtual void run(const float** inputs, float** outputs, uint32_t frames,
+                     const MidiEvent* midiEvents, uint32_t midiEventCount,
+                     const ParameterEvent* parameterEvents, uint32_t parameterEventCount) = 0;
+# else
+   /**
+      Run/process function for plugins without MIDI input but with sample-accurate parameter events.
+      Parameter changes at the start of the block are applied through setParameterValue() before this call,
+      later ones are given as a list sorted by frame, which the plugin is then responsible for applying.
+      @note Some parameters might be null if there are no audio inputs/outputs or parameter events.
+      @see AudioParameterSyncHelper
+    */
+    virtual void run(const float** inputs, float** outputs, uint32_t frames,
+                     const ParameterEvent* parameterEvents, uint32_t parameterEventCount) = 0;
+# endif
+#elif DISTRHO_PLUGIN_WANT_MIDI_INPUT
    /**
       Run/process function for plugins with MIDI input.
       @note Some parameters might be null if there are no audio inputs/outputs or MIDI events.
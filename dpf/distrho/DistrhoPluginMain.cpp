@@ -16,7 +16,9 @@
 
 #include "src/DistrhoPlugin.cpp"
 
-#if defined(DISTRHO_PLUGIN_TARGET_CARLA)
+#if defined(DISTRHO_PLUGIN_TARGET_BENCH)
+# include "src/DistrhoPluginBench.cpp"
+#elif defined(DISTRHO_PLUGIN_TARGET_CARLA)
 # include "src/DistrhoPluginCarla.cpp"
 #elif defined(DISTRHO_PLUGIN_TARGET_CLAP)
 # include "src/DistrhoPluginCLAP.cpp"
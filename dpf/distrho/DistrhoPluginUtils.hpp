@@ -206,6 +206,121 @@ private:
 };
 #endif
 
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS && DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+/**
+   Handy class to help keep audio buffer in sync with incoming parameter events.
+   To use it, create a local variable (on the stack) and call nextEvent() until it returns false.
+   @code
+    for (AudioParameterSyncHelper apsh(inputs, outputs, frames, parameterEvents, parameterEventCount); apsh.nextEvent();)
+    {
+        for (uint32_t i=0; i<apsh.parameterEventCount; ++i)
+        {
+            const ParameterEvent& ev(apsh.parameterEvents[i]);
+            setParameterValue(ev.index, ev.value);
+        }
+
+        processAudio(apsh.inputs, apsh.outputs, apsh.frames);
+    }
+   @endcode
+
+   Each iteration gives the events that must be applied before rendering the next @a frames,
+   the block is split right at the frame of each event.
+
+   Some important notes when using this class:
+    1. ParameterEvent::frame retains its original value, relative to the start of the full block.
+    2. The class variable names are the same as the default ones in the run function.
+ */
+struct AudioParameterSyncHelper
+{
+    /** Parameters from the run function, adjusted for event sync */
+   #if DISTRHO_PLUGIN_NUM_INPUTS > 0
+    const float* inputs[DISTRHO_PLUGIN_NUM_INPUTS];
+   #endif
+    float* outputs[DISTRHO_PLUGIN_NUM_OUTPUTS];
+    uint32_t frames;
+    const ParameterEvent* parameterEvents;
+    uint32_t parameterEventCount;
+
+    /**
+       Constructor, using values from the run function.
+    */
+    AudioParameterSyncHelper(const float** const i, float** const o, uint32_t f, const ParameterEvent* p, uint32_t pc)
+        : frames(0),
+          parameterEvents(p),
+          parameterEventCount(0),
+          remainingFrames(f),
+          remainingParameterEventCount(pc),
+          totalFramesUsed(0)
+    {
+       #if DISTRHO_PLUGIN_NUM_INPUTS > 0
+        for (uint32_t j=0; j<DISTRHO_PLUGIN_NUM_INPUTS; ++j)
+            inputs[j] = i[j];
+       #else
+        // unused
+        (void)i;
+       #endif
+        for (uint32_t j=0; j<DISTRHO_PLUGIN_NUM_OUTPUTS; ++j)
+            outputs[j] = o[j];
+    }
+
+    /**
+       Process a batch of events untill no more are available.
+       You must not read any more values from this class after this function returns false.
+    */
+    bool nextEvent()
+    {
+        // nothing else to do
+        if (remainingFrames == 0)
+            return false;
+
+        // move audio buffers past the previously rendered frames
+        if (frames != 0)
+        {
+           #if DISTRHO_PLUGIN_NUM_INPUTS > 0
+            for (uint32_t j=0; j<DISTRHO_PLUGIN_NUM_INPUTS; ++j)
+                inputs[j] += frames;
+           #endif
+            for (uint32_t j=0; j<DISTRHO_PLUGIN_NUM_OUTPUTS; ++j)
+                outputs[j] += frames;
+        }
+
+        // skip over the events given in the previous batch
+        parameterEvents += parameterEventCount;
+
+        // collect all events that happen at the current position
+        parameterEventCount = 0;
+        while (parameterEventCount < remainingParameterEventCount &&
+               parameterEvents[parameterEventCount].frame <= totalFramesUsed)
+            ++parameterEventCount;
+
+        remainingParameterEventCount -= parameterEventCount;
+
+        // render audio until the next event, or the end of the block
+        if (remainingParameterEventCount != 0)
+        {
+            const uint32_t nextEventFrame = parameterEvents[parameterEventCount].frame;
+            DISTRHO_SAFE_ASSERT_UINT2_RETURN(nextEventFrame < totalFramesUsed + remainingFrames,
+                                             nextEventFrame, totalFramesUsed + remainingFrames, false);
+            frames = nextEventFrame - totalFramesUsed;
+        }
+        else
+        {
+            frames = remainingFrames;
+        }
+
+        remainingFrames -= frames;
+        totalFramesUsed += frames;
+        return true;
+    }
+
+private:
+    /** @internal */
+    uint32_t remainingFrames;
+    uint32_t remainingParameterEventCount;
+    uint32_t totalFramesUsed;
+};
+#endif
+
 /** @} */
 
 // -----------------------------------------------------------------------------------------------------------
@@ -117,6 +117,40 @@ bool Plugin::isSelfTestInstance() const noexcept
     return pData->isSelfTest;
 }
 
+const float* Plugin::getParameterRamp(const uint32_t index) const noexcept
+{
+    DISTRHO_SAFE_ASSERT_RETURN(pData->parameterSmoothing != nullptr && index < pData->parameterCount, nullptr);
+
+    const ParameterSmoothing& smoothing(pData->parameterSmoothing[index]);
+    return smoothing.moving ? smoothing.ramp : nullptr;
+}
+
+float Plugin::getParameterModulatedValue(const uint32_t index, const float value) const noexcept
+{
+    DISTRHO_SAFE_ASSERT_RETURN(index < pData->parameterCount, value);
+
+    if (pData->parameterModulation == nullptr)
+        return value;
+
+    const float modulation = pData->parameterModulation[index];
+
+    if (d_isZero(modulation))
+        return value;
+
+    return pData->parameters[index].ranges.getFixedValue(value + modulation);
+}
+
+void Plugin::parallelFor(const uint32_t count, const ParallelTaskFunc task, void* const ptr)
+{
+    DISTRHO_SAFE_ASSERT_RETURN(task != nullptr,);
+
+    if (count > 1 && pData->parallelForCallback(count, task, ptr))
+        return;
+
+    for (uint32_t i=0; i < count; ++i)
+        task(ptr, i);
+}
+
 #if DISTRHO_PLUGIN_WANT_TIMEPOS
 const TimePosition& Plugin::getTimePosition() const noexcept
 {
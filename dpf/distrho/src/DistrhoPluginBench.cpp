@@ -0,0 +1,586 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2022 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "DistrhoPluginInternal.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#ifdef __SSE2_MATH__
+# include <xmmintrin.h>
+#endif
+
+START_NAMESPACE_DISTRHO
+
+// --------------------------------------------------------------------------------------------------------------------
+
+static constexpr const uint32_t kBenchDefaultBufferSizes[] = { 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+static constexpr const double kBenchDefaultSampleRates[] = { 44100.0, 48000.0, 96000.0, 192000.0 };
+
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+// how many notes are held at once by the synthetic MIDI pattern
+static constexpr const uint32_t kBenchChordSize = 3;
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   Offline renderer used for benchmarking plugin DSP code.
+   It drives the plugin directly through PluginExporter without any host, audio device or UI,
+   rendering a fixed amount of audio for each buffer size and sample rate combination.
+
+   Input is either a WAV file (looped and used as-is, no resampling) or a synthetic test signal.
+   Plugins with MIDI input receive a repeating chord pattern so that synths produce sound.
+ */
+class PluginBench
+{
+public:
+    struct Options {
+        std::vector<uint32_t> bufferSizes;
+        std::vector<double> sampleRates;
+        double seconds;
+        int automatedParameter;
+        std::vector<float> input;
+        uint32_t inputChannels;
+
+        Options()
+            : bufferSizes(kBenchDefaultBufferSizes, kBenchDefaultBufferSizes + ARRAY_SIZE(kBenchDefaultBufferSizes)),
+              sampleRates(kBenchDefaultSampleRates, kBenchDefaultSampleRates + ARRAY_SIZE(kBenchDefaultSampleRates)),
+              seconds(10.0),
+              automatedParameter(-1),
+              input(),
+              inputChannels(0) {}
+    };
+
+    struct Result {
+        uint64_t frames;
+        double totalTime;
+        double worstBlockTime;
+    };
+
+    PluginBench(const Options& options, const uint32_t bufferSize, const double sampleRate)
+        : fOptions(options),
+          fPlugin(nullptr, nullptr, nullptr, nullptr),
+          fBufferSize(bufferSize),
+          fSampleRate(sampleRate),
+          fInputPos(0),
+          fNoiseState(0x12345678u)
+    {
+       #if DISTRHO_PLUGIN_NUM_INPUTS > 0
+        for (uint32_t i = 0; i < DISTRHO_PLUGIN_NUM_INPUTS; ++i)
+            fInputBuffers[i] = new float[bufferSize];
+       #endif
+       #if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+        for (uint32_t i = 0; i < DISTRHO_PLUGIN_NUM_OUTPUTS; ++i)
+            fOutputBuffers[i] = new float[bufferSize];
+       #endif
+    }
+
+    ~PluginBench()
+    {
+       #if DISTRHO_PLUGIN_NUM_INPUTS > 0
+        for (uint32_t i = 0; i < DISTRHO_PLUGIN_NUM_INPUTS; ++i)
+            delete[] fInputBuffers[i];
+       #endif
+       #if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+        for (uint32_t i = 0; i < DISTRHO_PLUGIN_NUM_OUTPUTS; ++i)
+            delete[] fOutputBuffers[i];
+       #endif
+    }
+
+    const char* getName() const noexcept
+    {
+        return fPlugin.getName();
+    }
+
+    uint32_t getParameterCount() const noexcept
+    {
+        return fPlugin.getParameterCount();
+    }
+
+    void setParameterValue(const uint32_t index, const float value)
+    {
+        fPlugin.setParameterValue(index, value);
+    }
+
+    Result render()
+    {
+        const uint64_t totalFrames = static_cast<uint64_t>(fOptions.seconds * fSampleRate + 0.5);
+
+        Result result = { 0, 0.0, 0.0 };
+
+        fPlugin.activate();
+
+        // let the plugin settle before measuring, so one-time lazy setup does not skew results
+        for (uint32_t i = 0; i < 4; ++i)
+            process(0);
+
+        while (result.frames < totalFrames)
+        {
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            process(result.frames);
+            const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+            const double blockTime = std::chrono::duration<double>(end - start).count();
+
+            result.totalTime += blockTime;
+            if (blockTime > result.worstBlockTime)
+                result.worstBlockTime = blockTime;
+
+            result.frames += fBufferSize;
+        }
+
+        fPlugin.deactivate();
+        return result;
+    }
+
+private:
+    const Options& fOptions;
+    PluginExporter fPlugin;
+
+    const uint32_t fBufferSize;
+    const double fSampleRate;
+
+   #if DISTRHO_PLUGIN_NUM_INPUTS > 0
+    float* fInputBuffers[DISTRHO_PLUGIN_NUM_INPUTS];
+   #endif
+   #if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+    float* fOutputBuffers[DISTRHO_PLUGIN_NUM_OUTPUTS];
+   #endif
+
+    uint64_t fInputPos;
+    uint32_t fNoiseState;
+
+   #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+    MidiEvent fMidiEvents[kBenchChordSize * 2 * 64];
+   #endif
+
+    void process(const uint64_t position)
+    {
+        fillInputs();
+        automateParameter(position);
+
+        const float** const inputs = (const float**)(
+           #if DISTRHO_PLUGIN_NUM_INPUTS > 0
+            fInputBuffers
+           #else
+            nullptr
+           #endif
+        );
+        float** const outputs =
+           #if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+            fOutputBuffers;
+           #else
+            nullptr;
+           #endif
+
+       #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        const uint32_t midiEventCount = fillMidiEvents(position);
+        fPlugin.run(inputs, outputs, fBufferSize, fMidiEvents, midiEventCount);
+       #else
+        fPlugin.run(inputs, outputs, fBufferSize);
+       #endif
+    }
+
+    void fillInputs()
+    {
+       #if DISTRHO_PLUGIN_NUM_INPUTS > 0
+        if (fOptions.inputChannels != 0)
+        {
+            const uint64_t inputFrames = fOptions.input.size() / fOptions.inputChannels;
+
+            for (uint32_t i = 0; i < fBufferSize; ++i)
+            {
+                const float* const frame = &fOptions.input[((fInputPos + i) % inputFrames) * fOptions.inputChannels];
+
+                for (uint32_t c = 0; c < DISTRHO_PLUGIN_NUM_INPUTS; ++c)
+                    fInputBuffers[c][i] = frame[c % fOptions.inputChannels];
+            }
+        }
+        else
+        {
+            // 220Hz sine plus some white noise, both well below full-scale
+            const double omega = 2.0 * M_PI * 220.0 / fSampleRate;
+
+            for (uint32_t i = 0; i < fBufferSize; ++i)
+            {
+                fNoiseState = fNoiseState * 1664525u + 1013904223u;
+                const float noise = static_cast<float>(static_cast<int32_t>(fNoiseState)) / 2147483648.0f;
+                const float value = 0.25f * static_cast<float>(std::sin(omega * static_cast<double>(fInputPos + i)))
+                                  + 0.05f * noise;
+
+                for (uint32_t c = 0; c < DISTRHO_PLUGIN_NUM_INPUTS; ++c)
+                    fInputBuffers[c][i] = value;
+            }
+        }
+
+        fInputPos += fBufferSize;
+       #endif
+    }
+
+    void automateParameter(const uint64_t position)
+    {
+        if (fOptions.automatedParameter < 0)
+            return;
+
+        // slow sine sweep over the full parameter range, updated once per block
+        const uint32_t index = static_cast<uint32_t>(fOptions.automatedParameter);
+        const ParameterRanges& ranges(fPlugin.getParameterRanges(index));
+        const double phase = 2.0 * M_PI * 0.5 * static_cast<double>(position) / fSampleRate;
+        const float normalized = 0.5f + 0.5f * static_cast<float>(std::sin(phase));
+
+        fPlugin.setParameterValue(index, ranges.getUnnormalizedValue(normalized));
+    }
+
+   #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+    uint32_t fillMidiEvents(const uint64_t position)
+    {
+        static constexpr const uint8_t kNotes[] = { 48, 55, 60, 64, 67, 72, 76, 79 };
+
+        // a new chord every 250ms, released after 200ms
+        const uint64_t period = static_cast<uint64_t>(fSampleRate * 0.25);
+        const uint64_t length = static_cast<uint64_t>(fSampleRate * 0.2);
+        const uint64_t blockEnd = position + fBufferSize;
+        uint32_t count = 0;
+
+        for (uint64_t start = position - position % period; start < blockEnd; start += period)
+        {
+            const uint64_t step = start / period;
+
+            for (uint32_t n = 0; n < kBenchChordSize && count + 2 <= ARRAY_SIZE(fMidiEvents); ++n)
+            {
+                const uint8_t note = kNotes[(step + n * 2) % ARRAY_SIZE(kNotes)];
+
+                if (start >= position)
+                {
+                    MidiEvent& ev(fMidiEvents[count++]);
+                    ev.frame = static_cast<uint32_t>(start - position);
+                    ev.size = 3;
+                    ev.data[0] = 0x90;
+                    ev.data[1] = note;
+                    ev.data[2] = 100;
+                    ev.dataExt = nullptr;
+                }
+
+                if (start + length >= position && start + length < blockEnd)
+                {
+                    MidiEvent& ev(fMidiEvents[count++]);
+                    ev.frame = static_cast<uint32_t>(start + length - position);
+                    ev.size = 3;
+                    ev.data[0] = 0x80;
+                    ev.data[1] = note;
+                    ev.data[2] = 0;
+                    ev.dataExt = nullptr;
+                }
+            }
+        }
+
+        // note-offs of a chord can come after the following chord note-ons within the same block
+        for (uint32_t i = 1; i < count; ++i)
+        {
+            const MidiEvent ev(fMidiEvents[i]);
+            uint32_t j = i;
+
+            for (; j > 0 && fMidiEvents[j - 1].frame > ev.frame; --j)
+                fMidiEvents[j] = fMidiEvents[j - 1];
+
+            fMidiEvents[j] = ev;
+        }
+
+        return count;
+    }
+   #endif
+
+    DISTRHO_DECLARE_NON_COPYABLE(PluginBench)
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+
+static uint32_t readLE(const uint8_t* const data, const uint32_t size) noexcept
+{
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < size; ++i)
+        value |= static_cast<uint32_t>(data[i]) << (i * 8);
+    return value;
+}
+
+/**
+   Minimal WAV reader, supporting 16/24/32-bit integer and 32-bit float PCM.
+   Samples are stored interleaved as float.
+ */
+static bool loadWaveFile(const char* const filename, std::vector<float>& samples, uint32_t& channels)
+{
+    FILE* const file = std::fopen(filename, "rb");
+    DISTRHO_SAFE_ASSERT_RETURN(file != nullptr, false);
+
+    std::vector<uint8_t> data;
+    uint8_t buffer[4096];
+
+    for (size_t r; (r = std::fread(buffer, 1, sizeof(buffer), file)) != 0;)
+        data.insert(data.end(), buffer, buffer + r);
+
+    std::fclose(file);
+
+    DISTRHO_SAFE_ASSERT_RETURN(data.size() >= 12, false);
+    DISTRHO_SAFE_ASSERT_RETURN(std::memcmp(data.data(), "RIFF", 4) == 0, false);
+    DISTRHO_SAFE_ASSERT_RETURN(std::memcmp(data.data() + 8, "WAVE", 4) == 0, false);
+
+    uint32_t format = 0, bits = 0;
+    channels = 0;
+
+    for (size_t pos = 12; pos + 8 <= data.size();)
+    {
+        const uint8_t* const chunk = data.data() + pos;
+        const uint32_t chunkSize = readLE(chunk + 4, 4);
+        const size_t available = std::min<size_t>(chunkSize, data.size() - pos - 8);
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && available >= 16)
+        {
+            format = readLE(chunk + 8, 2);
+            channels = readLE(chunk + 10, 2);
+            bits = readLE(chunk + 22, 2);
+
+            // WAVE_FORMAT_EXTENSIBLE, real format is in the subformat GUID
+            if (format == 0xfffe && available >= 26)
+                format = readLE(chunk + 32, 2);
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0)
+        {
+            DISTRHO_SAFE_ASSERT_RETURN(channels != 0, false);
+
+            const uint8_t* const pcm = chunk + 8;
+            const uint32_t bytesPerSample = bits / 8;
+            DISTRHO_SAFE_ASSERT_RETURN(bytesPerSample != 0, false);
+
+            const size_t count = available / bytesPerSample;
+            samples.resize(count - count % channels);
+
+            for (size_t i = 0; i < samples.size(); ++i)
+            {
+                const uint8_t* const s = pcm + i * bytesPerSample;
+
+                if (format == 3 && bits == 32)
+                {
+                    const uint32_t v = readLE(s, 4);
+                    std::memcpy(&samples[i], &v, sizeof(float));
+                }
+                else if (format == 1 && bits == 16)
+                {
+                    samples[i] = static_cast<float>(static_cast<int16_t>(readLE(s, 2))) / 32768.0f;
+                }
+                else if (format == 1 && bits == 24)
+                {
+                    samples[i] = static_cast<float>(static_cast<int32_t>(readLE(s, 3) << 8) >> 8) / 8388608.0f;
+                }
+                else if (format == 1 && bits == 32)
+                {
+                    samples[i] = static_cast<float>(static_cast<int32_t>(readLE(s, 4))) / 2147483648.0f;
+                }
+                else
+                {
+                    d_stderr2("Unsupported WAV format %u with %u bits", format, bits);
+                    return false;
+                }
+            }
+
+            return ! samples.empty();
+        }
+
+        pos += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    return false;
+}
+
+template <typename T>
+static bool parseList(const char* const arg, std::vector<T>& list)
+{
+    list.clear();
+
+    for (const char* s = arg; *s != '\0';)
+    {
+        char* end = nullptr;
+        const double value = std::strtod(s, &end);
+
+        if (end == s || value <= 0.0)
+            return false;
+
+        list.push_back(static_cast<T>(value));
+        s = *end == ',' ? end + 1 : end;
+    }
+
+    return ! list.empty();
+}
+
+static void printUsage(const char* const program)
+{
+    d_stdout("Usage: %s [options]\n"
+             "\n"
+             "Renders audio offline through the plugin and reports DSP performance\n"
+             "for every combination of buffer size and sample rate.\n"
+             "Times are per sample frame, load is relative to realtime playback.\n"
+             "\n"
+             "Options:\n"
+             "  -b <sizes>        Comma-separated buffer sizes (default: 32,64,...,4096)\n"
+             "  -r <rates>        Comma-separated sample rates (default: 44100,48000,96000,192000)\n"
+             "  -s <seconds>      Amount of audio to render per combination (default: 10)\n"
+             "  -i <file.wav>     Use a WAV file as input instead of the synthetic signal\n"
+             "  -p <index=value>  Set a parameter before rendering (can be repeated)\n"
+             "  -a <index>        Automate a parameter with a slow sweep over its range\n"
+             "  -h                Show this help", program);
+}
+
+END_NAMESPACE_DISTRHO
+
+// --------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    USE_NAMESPACE_DISTRHO;
+
+    PluginBench::Options options;
+    std::vector<std::pair<uint32_t, float> > parameters;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* const arg = argv[i];
+
+        if (std::strcmp(arg, "-h") == 0 || std::strcmp(arg, "--help") == 0)
+        {
+            printUsage(argv[0]);
+            return 0;
+        }
+
+        if (arg[0] != '-' || arg[1] == '\0' || arg[2] != '\0' || i + 1 >= argc)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        const char* const value = argv[++i];
+        bool ok = true;
+
+        switch (arg[1])
+        {
+        case 'b':
+            ok = parseList(value, options.bufferSizes);
+            break;
+        case 'r':
+            ok = parseList(value, options.sampleRates);
+            break;
+        case 's':
+            options.seconds = std::atof(value);
+            ok = options.seconds > 0.0;
+            break;
+        case 'i':
+            ok = loadWaveFile(value, options.input, options.inputChannels);
+            if (! ok)
+                options.inputChannels = 0;
+            break;
+        case 'p':
+            if (const char* const sep = std::strchr(value, '='))
+                parameters.push_back(std::make_pair(static_cast<uint32_t>(std::atoi(value)),
+                                                    static_cast<float>(std::atof(sep + 1))));
+            else
+                ok = false;
+            break;
+        case 'a':
+            options.automatedParameter = std::atoi(value);
+            break;
+        default:
+            ok = false;
+            break;
+        }
+
+        if (! ok)
+        {
+            d_stderr2("Invalid value '%s' for option %s", value, arg);
+            return 1;
+        }
+    }
+
+    // same denormal handling as a regular audio thread
+   #if defined(__SSE2_MATH__)
+    _mm_setcsr(_mm_getcsr() | 0x8040);
+   #elif defined(__aarch64__)
+    uint64_t c;
+    __asm__ __volatile__("mrs %0, fpcr          \n"
+                         "orr %0, %0, #0x1000000\n"
+                         "msr fpcr, %0          \n"
+                         "isb                   \n"
+                         : "=r"(c) :: "memory");
+   #elif defined(__arm__)
+    uint32_t c;
+    __asm__ __volatile__("vmrs %0, fpscr         \n"
+                         "orr  %0, %0, #0x1000000\n"
+                         "vmsr fpscr, %0         \n"
+                         : "=r"(c) :: "memory");
+   #endif
+
+    bool printedHeader = false;
+
+    for (size_t r = 0; r < options.sampleRates.size(); ++r)
+    {
+        for (size_t b = 0; b < options.bufferSizes.size(); ++b)
+        {
+            const double sampleRate = options.sampleRates[r];
+            const uint32_t bufferSize = options.bufferSizes[b];
+
+            d_nextBufferSize = bufferSize;
+            d_nextSampleRate = sampleRate;
+            PluginBench bench(options, bufferSize, sampleRate);
+            d_nextBufferSize = 0;
+            d_nextSampleRate = 0.0;
+
+            if (options.automatedParameter >= static_cast<int>(bench.getParameterCount()))
+            {
+                d_stderr2("Parameter index %i is out of range", options.automatedParameter);
+                return 1;
+            }
+
+            for (size_t p = 0; p < parameters.size(); ++p)
+            {
+                DISTRHO_SAFE_ASSERT_CONTINUE(parameters[p].first < bench.getParameterCount());
+                bench.setParameterValue(parameters[p].first, parameters[p].second);
+            }
+
+            if (! printedHeader)
+            {
+                printedHeader = true;
+                d_stdout("%s: rendering %.1fs of audio per run\n"
+                         "    rate  frames   ns/sample   load %%   worst (us)   worst %%",
+                         bench.getName(), options.seconds);
+            }
+
+            const PluginBench::Result res = bench.render();
+
+            const double nsPerSample = res.totalTime * 1e9 / static_cast<double>(res.frames);
+            const double load = res.totalTime * sampleRate / static_cast<double>(res.frames) * 100.0;
+            const double worstLoad = res.worstBlockTime * sampleRate / bufferSize * 100.0;
+
+            d_stdout("%8.0f  %6u  %10.2f  %7.2f  %11.2f  %8.2f",
+                     sampleRate, bufferSize, nsPerSample, load, res.worstBlockTime * 1e6, worstLoad);
+        }
+    }
+
+    return 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
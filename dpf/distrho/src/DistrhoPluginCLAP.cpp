@@ -47,6 +47,7 @@
 #include "clap/ext/params.h"
 #include "clap/ext/state.h"
 #include "clap/ext/thread-check.h"
+#include "clap/ext/thread-pool.h"
 #include "clap/ext/timer-support.h"
 
 #if (defined(DISTRHO_OS_MAC) || defined(DISTRHO_OS_WINDOWS)) && ! DISTRHO_PLUGIN_HAS_EXTERNAL_UI
@@ -748,11 +749,14 @@ public:
           fLastKnownLatency(0),
          #endif
          #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-          fMidiEventCount(0),
+          fMidiEvents(fPlugin.getMidiEventArena()),
          #endif
+          fParallelTask(nullptr),
+          fParallelTaskPtr(nullptr),
           fHostExtensions(host)
     {
         fCachedParameters.setup(fPlugin.getParameterCount());
+        fPlugin.setParallelForCallback(parallelForCallback);
 
        #if DISTRHO_PLUGIN_HAS_UI && DISTRHO_PLUGIN_WANT_MIDI_INPUT
         fNotesRingBuffer.setRingBuffer(&fNotesBuffer, true);
@@ -813,7 +817,7 @@ public:
     bool process(const clap_process_t* const process)
     {
        #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-        fMidiEventCount = 0;
+        fMidiEvents.clear();
        #endif
 
        #if DISTRHO_PLUGIN_HAS_UI
@@ -963,9 +967,13 @@ public:
                     case CLAP_EVENT_PARAM_VALUE:
                         DISTRHO_SAFE_ASSERT_UINT2_BREAK(event->size == sizeof(clap_event_param_value),
                                                         event->size, sizeof(clap_event_param_value));
-                        setParameterValueFromEvent(static_cast<const clap_event_param_value*>(static_cast<const void*>(event)));
+                        setParameterValueFromEvent(static_cast<const clap_event_param_value*>(static_cast<const void*>(event)), true);
                         break;
                     case CLAP_EVENT_PARAM_MOD:
+                        DISTRHO_SAFE_ASSERT_UINT2_BREAK(event->size == sizeof(clap_event_param_mod),
+                                                        event->size, sizeof(clap_event_param_mod));
+                        setParameterModulationFromEvent(static_cast<const clap_event_param_mod*>(static_cast<const void*>(event)));
+                        break;
                     case CLAP_EVENT_PARAM_GESTURE_BEGIN:
                     case CLAP_EVENT_PARAM_GESTURE_END:
                     case CLAP_EVENT_TRANSPORT:
@@ -985,22 +993,22 @@ public:
         }
 
        #if DISTRHO_PLUGIN_HAS_UI && DISTRHO_PLUGIN_WANT_MIDI_INPUT
-        if (fMidiEventCount != kMaxMidiEvents && fNotesRingBuffer.isDataAvailableForReading())
+        if (! fMidiEvents.isFull() && fNotesRingBuffer.isDataAvailableForReading())
         {
             uint8_t midiData[3];
-            const uint32_t frame = fMidiEventCount != 0 ? fMidiEvents[fMidiEventCount-1].frame : 0;
+            MidiEvent midiEvent;
+            midiEvent.frame = fMidiEvents.count != 0 ? fMidiEvents.events[fMidiEvents.count-1].frame : 0;
+            midiEvent.size  = 3;
 
             while (fNotesRingBuffer.isDataAvailableForReading())
             {
                 if (! fNotesRingBuffer.readCustomData(midiData, 3))
                     break;
 
-                MidiEvent& midiEvent(fMidiEvents[fMidiEventCount++]);
-                midiEvent.frame = frame;
-                midiEvent.size  = 3;
                 std::memcpy(midiEvent.data, midiData, 3);
+                fMidiEvents.append(midiEvent);
 
-                if (fMidiEventCount == kMaxMidiEvents)
+                if (fMidiEvents.isFull())
                     break;
             }
         }
@@ -1065,7 +1073,7 @@ public:
             fOutputEvents = process->out_events;
 
            #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-            fPlugin.run(audioInputs, audioOutputs, frames, fMidiEvents, fMidiEventCount);
+            fPlugin.run(audioInputs, audioOutputs, frames, fMidiEvents.events, fMidiEvents.count);
            #else
             fPlugin.run(audioInputs, audioOutputs, frames);
            #endif
@@ -1075,6 +1083,13 @@ public:
 
             fOutputEvents = nullptr;
         }
+       #if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+        else
+        {
+            // no audio to process, apply pending parameter changes now
+            fPlugin.flushParameterEvents();
+        }
+       #endif
 
        #if DISTRHO_PLUGIN_WANT_LATENCY
         checkForLatencyChanges(true, false);
@@ -1122,6 +1137,9 @@ public:
             if (hints & (kParameterIsBoolean|kParameterIsInteger))
                 info->flags |= CLAP_PARAM_IS_STEPPED;
 
+            if (fPlugin.isParameterModulatable(index))
+                info->flags |= CLAP_PARAM_IS_MODULATABLE;
+
             DISTRHO_NAMESPACE::strncpy(info->name, fPlugin.getParameterName(index), CLAP_NAME_SIZE);
 
             uint wrtn;
@@ -1218,6 +1236,15 @@ public:
             {
                 const clap_event_header_t* const event = in->get(in, i);
 
+                if (event->type == CLAP_EVENT_PARAM_MOD)
+                {
+                    DISTRHO_SAFE_ASSERT_UINT2_BREAK(event->size == sizeof(clap_event_param_mod),
+                                                    event->size, sizeof(clap_event_param_mod));
+
+                    setParameterModulationFromEvent(static_cast<const clap_event_param_mod*>(static_cast<const void*>(event)));
+                    continue;
+                }
+
                 if (event->type != CLAP_EVENT_PARAM_VALUE)
                     continue;
 
@@ -1268,38 +1295,55 @@ public:
     {
         DISTRHO_SAFE_ASSERT_UINT_RETURN(event->port_index == 0, event->port_index,);
 
-        if (fMidiEventCount == kMaxMidiEvents)
-            return;
-
-        MidiEvent& midiEvent(fMidiEvents[fMidiEventCount++]);
+        MidiEvent midiEvent;
         midiEvent.frame = event->header.time;
         midiEvent.size  = 3;
         midiEvent.data[0] = (isOn ? 0x90 : 0x80) | (event->channel & 0x0F);
         midiEvent.data[1] = std::max(0, std::min(127, static_cast<int>(event->key)));
         midiEvent.data[2] = std::max(0, std::min(127, static_cast<int>(event->velocity * 127 + 0.5)));
+        fMidiEvents.append(midiEvent);
     }
 
     void addMidiEvent(const clap_event_midi_t* const event) noexcept
     {
         DISTRHO_SAFE_ASSERT_UINT_RETURN(event->port_index == 0, event->port_index,);
 
-        if (fMidiEventCount == kMaxMidiEvents)
-            return;
-
-        MidiEvent& midiEvent(fMidiEvents[fMidiEventCount++]);
+        MidiEvent midiEvent;
         midiEvent.frame = event->header.time;
         midiEvent.size  = 3;
         std::memcpy(midiEvent.data, event->data, 3);
+        fMidiEvents.append(midiEvent);
     }
    #endif
 
-    void setParameterValueFromEvent(const clap_event_param_value* const event)
+    void setParameterValueFromEvent(const clap_event_param_value* const event, const bool processing = false)
     {
         fCachedParameters.values[event->param_id] = event->value;
         fCachedParameters.changed[event->param_id] = true;
+
+       #if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+        if (processing)
+        {
+            fPlugin.addParameterEvent(event->header.time, event->param_id, event->value);
+            return;
+        }
+       #else
+        // unused
+        (void)processing;
+       #endif
+
         fPlugin.setParameterValue(event->param_id, event->value);
     }
 
+    void setParameterModulationFromEvent(const clap_event_param_mod* const event)
+    {
+        // only global modulation, per-note flags are never reported
+        if (event->note_id != -1 || event->key != -1)
+            return;
+
+        fPlugin.setParameterModulation(event->param_id, event->amount);
+    }
+
     // ----------------------------------------------------------------------------------------------------------------
     // audio ports
 
@@ -1393,6 +1437,17 @@ public:
     }
    #endif
 
+    // ----------------------------------------------------------------------------------------------------------------
+    // thread pool
+
+    // called from the host thread pool, during parallelFor()
+    void execParallelTask(const uint32_t index)
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fParallelTask != nullptr,);
+
+        fParallelTask(fParallelTaskPtr, index);
+    }
+
     // ----------------------------------------------------------------------------------------------------------------
     // state
 
@@ -1786,8 +1841,7 @@ private:
     uint32_t fLastKnownLatency;
    #endif
   #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-    uint32_t fMidiEventCount;
-    MidiEvent fMidiEvents[kMaxMidiEvents];
+    MidiEventArena& fMidiEvents;
    #if DISTRHO_PLUGIN_HAS_UI
     RingBufferControl<SmallStackBuffer> fNotesRingBuffer;
    #endif
@@ -1795,10 +1849,13 @@ private:
    #if DISTRHO_PLUGIN_WANT_TIMEPOS
     TimePosition fTimePosition;
    #endif
+    Plugin::ParallelTaskFunc fParallelTask;
+    void* fParallelTaskPtr;
 
     struct HostExtensions {
         const clap_host_t* const host;
         const clap_host_params_t* params;
+        const clap_host_thread_pool_t* threadPool;
        #if DISTRHO_PLUGIN_WANT_LATENCY
         const clap_host_latency_t* latency;
         const clap_host_thread_check_t* threadCheck;
@@ -1806,7 +1863,8 @@ private:
 
         HostExtensions(const clap_host_t* const host)
             : host(host),
-              params(nullptr)
+              params(nullptr),
+              threadPool(nullptr)
            #if DISTRHO_PLUGIN_WANT_LATENCY
             , latency(nullptr)
             , threadCheck(nullptr)
@@ -1816,6 +1874,7 @@ private:
         bool init()
         {
             params = static_cast<const clap_host_params_t*>(host->get_extension(host, CLAP_EXT_PARAMS));
+            threadPool = static_cast<const clap_host_thread_pool_t*>(host->get_extension(host, CLAP_EXT_THREAD_POOL));
            #if DISTRHO_PLUGIN_WANT_LATENCY
             DISTRHO_SAFE_ASSERT_RETURN(host->request_restart != nullptr, false);
             DISTRHO_SAFE_ASSERT_RETURN(host->request_callback != nullptr, false);
@@ -1993,6 +2052,27 @@ private:
     // ----------------------------------------------------------------------------------------------------------------
     // DPF callbacks
 
+    bool parallelFor(const uint32_t count, const Plugin::ParallelTaskFunc task, void* const taskPtr)
+    {
+        if (fHostExtensions.threadPool == nullptr || fHostExtensions.threadPool->request_exec == nullptr)
+            return false;
+
+        fParallelTask = task;
+        fParallelTaskPtr = taskPtr;
+
+        // the host may refuse, in which case DPF runs the tasks serially
+        const bool ok = fHostExtensions.threadPool->request_exec(fHost, count);
+
+        fParallelTask = nullptr;
+        fParallelTaskPtr = nullptr;
+        return ok;
+    }
+
+    static bool parallelForCallback(void* const ptr, const uint32_t count, const Plugin::ParallelTaskFunc task, void* const taskPtr)
+    {
+        return static_cast<PluginCLAP*>(ptr)->parallelFor(count, task, taskPtr);
+    }
+
    #if DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
     bool writeMidi(const MidiEvent& midiEvent)
     {
@@ -2363,6 +2443,19 @@ static const clap_plugin_latency_t clap_plugin_latency = {
 };
 #endif
 
+// --------------------------------------------------------------------------------------------------------------------
+// plugin thread pool
+
+static CLAP_ABI void clap_plugin_thread_pool_exec(const clap_plugin_t* const plugin, const uint32_t task_index)
+{
+    PluginCLAP* const instance = static_cast<PluginCLAP*>(plugin->plugin_data);
+    instance->execParallelTask(task_index);
+}
+
+static const clap_plugin_thread_pool_t clap_plugin_thread_pool = {
+    clap_plugin_thread_pool_exec
+};
+
 #if DISTRHO_PLUGIN_WANT_STATE
 // --------------------------------------------------------------------------------------------------------------------
 // plugin state
@@ -2445,6 +2538,8 @@ static CLAP_ABI const void* clap_plugin_get_extension(const clap_plugin_t*, cons
 {
     if (std::strcmp(id, CLAP_EXT_PARAMS) == 0)
         return &clap_plugin_params;
+    if (std::strcmp(id, CLAP_EXT_THREAD_POOL) == 0)
+        return &clap_plugin_thread_pool;
    #if DISTRHO_PLUGIN_NUM_INPUTS+DISTRHO_PLUGIN_NUM_OUTPUTS != 0
     if (std::strcmp(id, CLAP_EXT_AUDIO_PORTS) == 0)
         return &clap_plugin_audio_ports;
@@ -69,6 +69,10 @@
 # define DISTRHO_PLUGIN_WANT_MIDI_OUTPUT 0
 #endif
 
+#ifndef DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+# define DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS 0
+#endif
+
 #ifndef DISTRHO_PLUGIN_WANT_PARAMETER_VALUE_CHANGE_REQUEST
 # define DISTRHO_PLUGIN_WANT_PARAMETER_VALUE_CHANGE_REQUEST 0
 #endif
@@ -23,6 +23,7 @@
 # include "DistrhoPluginVST.hpp"
 #endif
 
+#include <algorithm>
 #include <set>
 
 START_NAMESPACE_DISTRHO
@@ -30,7 +31,9 @@ START_NAMESPACE_DISTRHO
 // -----------------------------------------------------------------------
 // Maxmimum values
 
-static const uint32_t kMaxMidiEvents = 512;
+static const uint32_t kMinMidiEvents = 512;
+static const uint32_t kMidiEventsPerFrame = 2;
+static const uint32_t kMaxParameterEvents = 512;
 
 // -----------------------------------------------------------------------
 // Static data, see DistrhoPlugin.cpp
@@ -48,6 +51,7 @@ extern bool        d_nextCanRequestParameterValueChanges;
 typedef bool (*writeMidiFunc) (void* ptr, const MidiEvent& midiEvent);
 typedef bool (*requestParameterValueChangeFunc) (void* ptr, uint32_t index, float value);
 typedef bool (*updateStateValueFunc) (void* ptr, const char* key, const char* value);
+typedef bool (*parallelForFunc) (void* ptr, uint32_t count, Plugin::ParallelTaskFunc task, void* taskPtr);
 
 // -----------------------------------------------------------------------
 // Helpers
@@ -137,6 +141,180 @@ void snprintf_u32(char* const dst, const uint32_t value, const size_t size)
     return snprintf_t<uint32_t>(dst, value, "%u", size);
 }
 
+struct ParameterSmoothing {
+    float value;
+    float coeff;
+    uint32_t coeffFrames;
+    float* ramp;
+    bool moving;
+
+    ParameterSmoothing() noexcept
+        : value(0.0f),
+          coeff(0.0f),
+          coeffFrames(0),
+          ramp(nullptr),
+          moving(false) {}
+
+    ~ParameterSmoothing() noexcept
+    {
+        delete[] ramp;
+    }
+
+    DISTRHO_DECLARE_NON_COPYABLE(ParameterSmoothing)
+};
+
+// -----------------------------------------------------------------------
+// MIDI input events of a single run() call
+
+struct MidiEventArena {
+    MidiEvent* events;
+    uint32_t count;
+    uint32_t capacity;
+
+    MidiEventArena() noexcept
+        : events(nullptr),
+          count(0),
+          capacity(0),
+          compacted(false) {}
+
+    ~MidiEventArena() noexcept
+    {
+        delete[] events;
+    }
+
+    // not realtime safe, must not be called while processing
+    void resize(const uint32_t bufferSize)
+    {
+        const uint32_t newCapacity = std::max(kMinMidiEvents, bufferSize * kMidiEventsPerFrame);
+
+        if (newCapacity <= capacity)
+            return;
+
+        delete[] events;
+        events = new MidiEvent[newCapacity];
+        capacity = newCapacity;
+        clear();
+    }
+
+    void clear() noexcept
+    {
+        count = 0;
+        compacted = false;
+    }
+
+    bool isFull() const noexcept
+    {
+        return count == capacity;
+    }
+
+    // events must be appended in frame order, returns false if dropped.
+    // when out of space, controller changes replace older changes of the same controller
+    // instead of being dropped, and the first other event merges all such changes once.
+    bool append(const MidiEvent& midiEvent) noexcept
+    {
+        if (count != capacity)
+        {
+            events[count++] = midiEvent;
+            return true;
+        }
+
+        const int key = getControllerKey(midiEvent);
+
+        if (key >= 0)
+        {
+            for (uint32_t i = count; i-- != 0;)
+            {
+                if (getControllerKey(events[i]) != key)
+                    continue;
+
+                std::memmove(events + i, events + i + 1, sizeof(MidiEvent) * (count - i - 1));
+                events[count - 1] = midiEvent;
+                return true;
+            }
+        }
+
+        if (compacted)
+            return false;
+
+        compacted = true;
+        compact();
+
+        if (count == capacity)
+            return false;
+
+        events[count++] = midiEvent;
+        return true;
+    }
+
+private:
+    // 128 controllers, 128 poly pressure keys, channel pressure and pitchbend per channel
+    enum { kControllerKeysPerChannel = 258, kControllerKeyCount = 16 * kControllerKeysPerChannel };
+
+    bool compacted;
+    uint8_t seenKeys[(kControllerKeyCount + 7) / 8];
+
+    // returns -1 for events that must never be merged
+    static int getControllerKey(const MidiEvent& midiEvent) noexcept
+    {
+        if (midiEvent.size < 2 || midiEvent.size > MidiEvent::kDataSize)
+            return -1;
+
+        const int channel = midiEvent.data[0] & 0x0F;
+        const uint8_t data1 = midiEvent.data[1] & 0x7F;
+
+        switch (midiEvent.data[0] & 0xF0)
+        {
+        case 0xA0:
+            return channel * kControllerKeysPerChannel + 128 + data1;
+        case 0xB0:
+            // keep bank select, data entry, (N)RPN sequences and channel mode messages intact
+            if (data1 == 0 || data1 == 6 || data1 == 32 || data1 == 38 || (data1 >= 96 && data1 <= 101) || data1 >= 120)
+                return -1;
+            return channel * kControllerKeysPerChannel + data1;
+        case 0xD0:
+            return channel * kControllerKeysPerChannel + 256;
+        case 0xE0:
+            return channel * kControllerKeysPerChannel + 257;
+        }
+
+        return -1;
+    }
+
+    // keep only the last change of each controller, in place and in order
+    void compact() noexcept
+    {
+        std::memset(seenKeys, 0, sizeof(seenKeys));
+
+        uint32_t kept = count;
+
+        for (uint32_t i = count; i-- != 0;)
+        {
+            const int key = getControllerKey(events[i]);
+
+            if (key >= 0)
+            {
+                uint8_t& bits(seenKeys[key / 8]);
+                const uint8_t mask = 1 << (key % 8);
+
+                if (bits & mask)
+                    continue;
+
+                bits |= mask;
+            }
+
+            events[--kept] = events[i];
+        }
+
+        if (kept == 0)
+            return;
+
+        std::memmove(events, events + kept, sizeof(MidiEvent) * (count - kept));
+        count -= kept;
+    }
+
+    DISTRHO_DECLARE_NON_COPYABLE(MidiEventArena)
+};
+
 // -----------------------------------------------------------------------
 // Plugin private data
 
@@ -153,6 +331,8 @@ struct Plugin::PrivateData {
     uint32_t   parameterCount;
     uint32_t   parameterOffset;
     Parameter* parameters;
+    ParameterSmoothing* parameterSmoothing;
+    float*     parameterModulation;
 
     uint32_t         portGroupCount;
     PortGroupWithId* portGroups;
@@ -180,6 +360,7 @@ struct Plugin::PrivateData {
     writeMidiFunc writeMidiCallbackFunc;
     requestParameterValueChangeFunc requestParameterValueChangeCallbackFunc;
     updateStateValueFunc updateStateValueCallbackFunc;
+    parallelForFunc parallelForCallbackFunc;
 
     uint32_t bufferSize;
     double   sampleRate;
@@ -196,6 +377,8 @@ struct Plugin::PrivateData {
           parameterCount(0),
           parameterOffset(0),
           parameters(nullptr),
+          parameterSmoothing(nullptr),
+          parameterModulation(nullptr),
           portGroupCount(0),
           portGroups(nullptr),
 #if DISTRHO_PLUGIN_WANT_PROGRAMS
@@ -213,6 +396,7 @@ struct Plugin::PrivateData {
           writeMidiCallbackFunc(nullptr),
           requestParameterValueChangeCallbackFunc(nullptr),
           updateStateValueCallbackFunc(nullptr),
+          parallelForCallbackFunc(nullptr),
           bufferSize(d_nextBufferSize),
           sampleRate(d_nextSampleRate),
           bundlePath(d_nextBundlePath != nullptr ? strdup(d_nextBundlePath) : nullptr)
@@ -257,6 +441,18 @@ struct Plugin::PrivateData {
             parameters = nullptr;
         }
 
+        if (parameterSmoothing != nullptr)
+        {
+            delete[] parameterSmoothing;
+            parameterSmoothing = nullptr;
+        }
+
+        if (parameterModulation != nullptr)
+        {
+            delete[] parameterModulation;
+            parameterModulation = nullptr;
+        }
+
         if (portGroups != nullptr)
         {
             delete[] portGroups;
@@ -316,6 +512,14 @@ struct Plugin::PrivateData {
         return false;
     }
 #endif
+
+    bool parallelForCallback(const uint32_t count, const Plugin::ParallelTaskFunc task, void* const taskPtr)
+    {
+        if (parallelForCallbackFunc != nullptr)
+            return parallelForCallbackFunc(callbacksPtr, count, task, taskPtr);
+
+        return false;
+    }
 };
 
 // -----------------------------------------------------------------------
@@ -331,10 +535,17 @@ public:
         : fPlugin(createPlugin()),
           fData((fPlugin != nullptr) ? fPlugin->pData : nullptr),
           fIsActive(false)
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+        , fParameterEventCount(0)
+#endif
     {
         DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
         DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
 
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        fMidiEventArena.resize(fData->bufferSize);
+#endif
+
 #if defined(DPF_RUNTIME_TESTING) && defined(__GNUC__) && !defined(__clang__)
         /* Run-time testing build.
          * Verify that virtual functions are overriden if parameters, programs or states are in use.
@@ -467,6 +678,28 @@ public:
             fPlugin->initState(i, fData->states[i]);
 #endif
 
+        for (uint32_t i=0, count=fData->parameterCount; i < count; ++i)
+        {
+            if (! isParameterSmoothed(i))
+                continue;
+
+            if (fData->parameterSmoothing == nullptr)
+                fData->parameterSmoothing = new ParameterSmoothing[count];
+
+            fData->parameterSmoothing[i].value = fPlugin->getParameterValue(i);
+            fData->parameterSmoothing[i].ramp = new float[fData->bufferSize];
+        }
+
+        for (uint32_t i=0, count=fData->parameterCount; i < count; ++i)
+        {
+            if (! isParameterModulatable(i))
+                continue;
+
+            fData->parameterModulation = new float[count];
+            std::memset(fData->parameterModulation, 0, sizeof(float)*count);
+            break;
+        }
+
         fData->callbacksPtr = callbacksPtr;
         fData->writeMidiCallbackFunc = writeMidiCall;
         fData->requestParameterValueChangeCallbackFunc = requestParameterValueChangeCall;
@@ -657,6 +890,30 @@ public:
         return (getParameterHints(index) & kParameterIsTrigger) == kParameterIsTrigger;
     }
 
+    bool isParameterSmoothed(const uint32_t index) const noexcept
+    {
+        const uint32_t hints = getParameterHints(index);
+
+        if ((hints & kParameterIsSmoothed) == 0x0)
+            return false;
+        if (hints & (kParameterIsOutput|kParameterIsBoolean|kParameterIsInteger))
+            return false;
+
+        return true;
+    }
+
+    bool isParameterModulatable(const uint32_t index) const noexcept
+    {
+        const uint32_t hints = getParameterHints(index);
+
+        if ((hints & kParameterIsModulatable) == 0x0)
+            return false;
+        if (hints & (kParameterIsOutput|kParameterIsBoolean|kParameterIsInteger))
+            return false;
+
+        return true;
+    }
+
     bool isParameterOutputOrTrigger(const uint32_t index) const noexcept
     {
         const uint32_t hints = getParameterHints(index);
@@ -756,6 +1013,75 @@ public:
         fPlugin->setParameterValue(index, value);
     }
 
+    void setParallelForCallback(const parallelForFunc parallelForCall) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
+
+        fData->parallelForCallbackFunc = parallelForCall;
+    }
+
+    void setParameterModulation(const uint32_t index, const float modulation) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr && index < fData->parameterCount,);
+
+        if (fData->parameterModulation == nullptr || ! isParameterModulatable(index))
+            return;
+
+        fData->parameterModulation[index] = modulation;
+    }
+
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+    void addParameterEvent(const uint32_t frame, const uint32_t index, const float value)
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr && index < fData->parameterCount,);
+
+        // changes at the start of the block do not need to be delayed
+        if (frame == 0)
+        {
+            fPlugin->setParameterValue(index, value);
+            return;
+        }
+
+        // when out of space, merge with the last pending change for the same parameter
+        if (fParameterEventCount == kMaxParameterEvents)
+        {
+            for (uint32_t i = fParameterEventCount; i-- != 0;)
+            {
+                if (fParameterEvents[i].index == index)
+                {
+                    fParameterEvents[i].value = value;
+                    return;
+                }
+            }
+
+            fPlugin->setParameterValue(index, value);
+            return;
+        }
+
+        // keep the list sorted by frame, events on the same frame stay in the order they came in
+        uint32_t pos = fParameterEventCount++;
+
+        for (; pos != 0 && fParameterEvents[pos-1].frame > frame; --pos)
+            fParameterEvents[pos] = fParameterEvents[pos-1];
+
+        ParameterEvent& parameterEvent(fParameterEvents[pos]);
+        parameterEvent.frame = frame;
+        parameterEvent.index = index;
+        parameterEvent.value = value;
+    }
+
+    void flushParameterEvents()
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
+
+        for (uint32_t i=0; i < fParameterEventCount; ++i)
+            fPlugin->setParameterValue(fParameterEvents[i].index, fParameterEvents[i].value);
+
+        fParameterEventCount = 0;
+    }
+#endif
+
     uint32_t getPortGroupCount() const noexcept
     {
         DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, 0);
@@ -904,6 +1230,15 @@ public:
 
     // -------------------------------------------------------------------
 
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+    MidiEventArena& getMidiEventArena() noexcept
+    {
+        return fMidiEventArena;
+    }
+
+    // -------------------------------------------------------------------
+#endif
+
     bool isActive() const noexcept
     {
         return fIsActive;
@@ -915,6 +1250,7 @@ public:
         DISTRHO_SAFE_ASSERT_RETURN(! fIsActive,);
 
         fIsActive = true;
+        resetParameterSmoothing();
         fPlugin->activate();
     }
 
@@ -948,11 +1284,21 @@ public:
         if (! fIsActive)
         {
             fIsActive = true;
+            resetParameterSmoothing();
             fPlugin->activate();
         }
 
+        if (fData->parameterSmoothing != nullptr)
+            updateParameterRamps(frames);
+
         fData->isProcessing = true;
+# if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+        clampParameterEvents(frames);
+        fPlugin->run(inputs, outputs, frames, midiEvents, midiEventCount, fParameterEvents, fParameterEventCount);
+        fParameterEventCount = 0;
+# else
         fPlugin->run(inputs, outputs, frames, midiEvents, midiEventCount);
+# endif
         fData->isProcessing = false;
     }
 #else
@@ -964,11 +1310,21 @@ public:
         if (! fIsActive)
         {
             fIsActive = true;
+            resetParameterSmoothing();
             fPlugin->activate();
         }
 
+        if (fData->parameterSmoothing != nullptr)
+            updateParameterRamps(frames);
+
         fData->isProcessing = true;
+# if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+        clampParameterEvents(frames);
+        fPlugin->run(inputs, outputs, frames, fParameterEvents, fParameterEventCount);
+        fParameterEventCount = 0;
+# else
         fPlugin->run(inputs, outputs, frames);
+# endif
         fData->isProcessing = false;
     }
 #endif
@@ -998,6 +1354,23 @@ public:
 
         fData->bufferSize = bufferSize;
 
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        fMidiEventArena.resize(bufferSize);
+#endif
+
+        if (ParameterSmoothing* const parameterSmoothing = fData->parameterSmoothing)
+        {
+            for (uint32_t i=0, count=fData->parameterCount; i < count; ++i)
+            {
+                if (parameterSmoothing[i].ramp == nullptr)
+                    continue;
+
+                delete[] parameterSmoothing[i].ramp;
+                parameterSmoothing[i].ramp = new float[bufferSize];
+                parameterSmoothing[i].moving = false;
+            }
+        }
+
         if (doCallback)
         {
             if (fIsActive) fPlugin->deactivate();
@@ -1017,6 +1390,12 @@ public:
 
         fData->sampleRate = sampleRate;
 
+        if (ParameterSmoothing* const parameterSmoothing = fData->parameterSmoothing)
+        {
+            for (uint32_t i=0, count=fData->parameterCount; i < count; ++i)
+                parameterSmoothing[i].coeffFrames = 0;
+        }
+
         if (doCallback)
         {
             if (fIsActive) fPlugin->deactivate();
@@ -1033,6 +1412,91 @@ private:
     Plugin::PrivateData* const fData;
     bool fIsActive;
 
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+    MidiEventArena fMidiEventArena;
+#endif
+
+    // -------------------------------------------------------------------
+    // Parameter smoothing
+
+    void resetParameterSmoothing()
+    {
+        ParameterSmoothing* const parameterSmoothing = fData->parameterSmoothing;
+
+        if (parameterSmoothing == nullptr)
+            return;
+
+        for (uint32_t i=0, count=fData->parameterCount; i < count; ++i)
+        {
+            if (parameterSmoothing[i].ramp == nullptr)
+                continue;
+
+            parameterSmoothing[i].value = fPlugin->getParameterValue(i);
+            parameterSmoothing[i].moving = false;
+        }
+    }
+
+    void updateParameterRamps(const uint32_t frames)
+    {
+        ParameterSmoothing* const parameterSmoothing = fData->parameterSmoothing;
+
+        for (uint32_t i=0, count=fData->parameterCount; i < count; ++i)
+        {
+            ParameterSmoothing& smoothing(parameterSmoothing[i]);
+
+            if (smoothing.ramp == nullptr)
+                continue;
+
+            const float target = fPlugin->getParameterValue(i);
+            const float start = smoothing.value;
+
+            if (d_isEqual(start, target) || frames == 0 || frames > fData->bufferSize)
+            {
+                smoothing.value = target;
+                smoothing.moving = false;
+                continue;
+            }
+
+            // exponential approach sampled once per block, linear ramp in between
+            if (smoothing.coeffFrames != frames)
+            {
+                const double timeInFrames = fData->parameters[i].smoothTime * 0.001 * fData->sampleRate;
+
+                smoothing.coeffFrames = frames;
+                smoothing.coeff = timeInFrames > 1.0 ? static_cast<float>(std::exp(-(frames / timeInFrames))) : 0.0f;
+            }
+
+            const ParameterRanges& ranges(fData->parameters[i].ranges);
+            float end = target + (start - target) * smoothing.coeff;
+
+            if (std::abs(target - end) < (ranges.max - ranges.min) * 1e-5f)
+                end = target;
+
+            const float step = (end - start) / frames;
+
+            for (uint32_t j=0; j < frames; ++j)
+                smoothing.ramp[j] = start + step * (j + 1);
+
+            smoothing.value = end;
+            smoothing.moving = true;
+        }
+    }
+
+#if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+    // -------------------------------------------------------------------
+    // Pending sample-accurate parameter changes, sorted by frame
+
+    ParameterEvent fParameterEvents[kMaxParameterEvents];
+    uint32_t fParameterEventCount;
+
+    void clampParameterEvents(const uint32_t frames) noexcept
+    {
+        // hosts should never send events past the end of the block, but just in case
+        for (uint32_t i = fParameterEventCount; i-- != 0 && fParameterEvents[i].frame >= frames;)
+            fParameterEvents[i].frame = frames != 0 ? frames - 1 : 0;
+    }
+#endif
+
     // -------------------------------------------------------------------
     // Static fallback data, see DistrhoPlugin.cpp
 
@@ -418,32 +418,28 @@ protected:
 #endif
 
 #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-        uint32_t  midiEventCount = 0;
-        MidiEvent midiEvents[512];
+        MidiEventArena& midiEvents(fPlugin.getMidiEventArena());
+        midiEvents.clear();
 
 # if DISTRHO_PLUGIN_HAS_UI
-        while (fNotesRingBuffer.isDataAvailableForReading())
+        while (! midiEvents.isFull() && fNotesRingBuffer.isDataAvailableForReading())
         {
             uint8_t midiData[3];
             if (! fNotesRingBuffer.readCustomData(midiData, 3))
                 break;
 
-            MidiEvent& midiEvent(midiEvents[midiEventCount++]);
+            MidiEvent midiEvent;
             midiEvent.frame = 0;
             midiEvent.size  = 3;
             std::memcpy(midiEvent.data, midiData, 3);
-
-            if (midiEventCount == 512)
-                break;
+            midiEvents.append(midiEvent);
         }
 # endif
-#else
-        static const uint32_t midiEventCount = 0;
 #endif
 
         void* const midiInBuf = jackbridge_port_get_buffer(fPortEventsIn, nframes);
 
-        if (const uint32_t eventCount = std::min(512u - midiEventCount, jackbridge_midi_get_event_count(midiInBuf)))
+        if (const uint32_t eventCount = jackbridge_midi_get_event_count(midiInBuf))
         {
             jack_midi_event_t jevent;
 
@@ -493,21 +489,28 @@ protected:
 #endif
 
 #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-                MidiEvent& midiEvent(midiEvents[midiEventCount++]);
+                MidiEvent midiEvent;
 
                 midiEvent.frame = jevent.time;
                 midiEvent.size  = static_cast<uint32_t>(jevent.size);
 
                 if (midiEvent.size > MidiEvent::kDataSize)
+                {
                     midiEvent.dataExt = jevent.buffer;
+                }
                 else
+                {
+                    midiEvent.dataExt = nullptr;
                     std::memcpy(midiEvent.data, jevent.buffer, midiEvent.size);
+                }
+
+                midiEvents.append(midiEvent);
 #endif
             }
         }
 
 #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-        fPlugin.run(audioIns, audioOuts, nframes, midiEvents, midiEventCount);
+        fPlugin.run(audioIns, audioOuts, nframes, midiEvents.events, midiEvents.count);
 #else
         fPlugin.run(audioIns, audioOuts, nframes);
 #endif
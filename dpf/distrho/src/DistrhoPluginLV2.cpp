@@ -84,6 +84,11 @@ public:
           fPortControls(nullptr),
           fLastControlValues(nullptr),
           fSampleRate(sampleRate),
+          fInputParameterIndexes(nullptr),
+          fInputParameterCount(0),
+          fOutputParameterIndexes(nullptr),
+          fOutputParameterCount(0),
+          fBypassParameterIndex(UINT32_MAX),
           fURIDs(uridMap),
 #if DISTRHO_PLUGIN_WANT_PARAMETER_VALUE_CHANGE_REQUEST
           fCtrlInPortChangeReq(ctrlInPortChangeReq),
@@ -109,11 +114,21 @@ public:
         {
             fPortControls      = new float*[count];
             fLastControlValues = new float[count];
+            fInputParameterIndexes  = new uint32_t[count];
+            fOutputParameterIndexes = new uint32_t[count];
 
             for (uint32_t i=0; i < count; ++i)
             {
                 fPortControls[i] = nullptr;
                 fLastControlValues[i] = fPlugin.getParameterValue(i);
+
+                if (fPlugin.isParameterOutput(i))
+                    fOutputParameterIndexes[fOutputParameterCount++] = i;
+                else if (fPlugin.isParameterInput(i))
+                    fInputParameterIndexes[fInputParameterCount++] = i;
+
+                if (fPlugin.getParameterDesignation(i) == kParameterDesignationBypass)
+                    fBypassParameterIndex = i;
             }
         }
         else
@@ -180,6 +195,18 @@ public:
             fLastControlValues = nullptr;
         }
 
+        if (fInputParameterIndexes != nullptr)
+        {
+            delete[] fInputParameterIndexes;
+            fInputParameterIndexes = nullptr;
+        }
+
+        if (fOutputParameterIndexes != nullptr)
+        {
+            delete[] fOutputParameterIndexes;
+            fOutputParameterIndexes = nullptr;
+        }
+
 #if DISTRHO_PLUGIN_WANT_STATE
         if (fNeededUiSends != nullptr)
         {
@@ -203,16 +230,7 @@ public:
     {
         if (const float* control = fPortControls[index])
         {
-            switch (fPlugin.getParameterDesignation(index))
-            {
-            default:
-                value = *control;
-                break;
-            case kParameterDesignationBypass:
-                value = 1.0f - *control;
-                break;
-            }
-
+            value = index == fBypassParameterIndex ? 1.0f - *control : *control;
             return true;
         }
 
@@ -222,17 +240,7 @@ public:
     void setPortControlValue(uint32_t index, float value)
     {
         if (float* control = fPortControls[index])
-        {
-            switch (fPlugin.getParameterDesignation(index))
-            {
-            default:
-                *control = value;
-                break;
-            case kParameterDesignationBypass:
-                *control = 1.0f - value;
-                break;
-            }
-        }
+            *control = index == fBypassParameterIndex ? 1.0f - value : value;
     }
 
     // -------------------------------------------------------------------
@@ -328,7 +336,8 @@ public:
     {
         // cache midi input and time position first
 #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-        uint32_t midiEventCount = 0;
+        MidiEventArena& midiEvents(fPlugin.getMidiEventArena());
+        midiEvents.clear();
 #endif
 
 #if DISTRHO_PLUGIN_WANT_MIDI_INPUT || DISTRHO_PLUGIN_WANT_TIMEPOS
@@ -340,12 +349,9 @@ public:
 # if DISTRHO_PLUGIN_WANT_MIDI_INPUT
             if (event->body.type == fURIDs.midiEvent)
             {
-                if (midiEventCount >= kMaxMidiEvents)
-                    continue;
-
                 const uint8_t* const data((const uint8_t*)(event + 1));
 
-                MidiEvent& midiEvent(fMidiEvents[midiEventCount++]);
+                MidiEvent midiEvent;
 
                 midiEvent.frame = event->time.frames;
                 midiEvent.size  = event->body.size;
@@ -361,6 +367,7 @@ public:
                     std::memcpy(midiEvent.data, data, midiEvent.size);
                 }
 
+                midiEvents.append(midiEvent);
                 continue;
             }
 # endif
@@ -601,19 +608,21 @@ public:
         }
 #endif
 
-        // Check for updated parameters
+        // Check for updated parameters, only input ports need to be compared
         float curValue;
 
-        for (uint32_t i=0, count=fPlugin.getParameterCount(); i < count; ++i)
+        for (uint32_t i=0; i < fInputParameterCount; ++i)
         {
-            if (!getPortControlValue(i, curValue))
+            const uint32_t index = fInputParameterIndexes[i];
+
+            if (!getPortControlValue(index, curValue))
                 continue;
 
-            if (fPlugin.isParameterInput(i) && d_isNotEqual(fLastControlValues[i], curValue))
+            if (d_isNotEqual(fLastControlValues[index], curValue))
             {
-                fLastControlValues[i] = curValue;
+                fLastControlValues[index] = curValue;
 
-                fPlugin.setParameterValue(i, curValue);
+                fPlugin.setParameterValue(index, curValue);
             }
         }
 
@@ -625,7 +634,7 @@ public:
            #endif
 
            #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-            fPlugin.run(fPortAudioIns, fPortAudioOuts, sampleCount, fMidiEvents, midiEventCount);
+            fPlugin.run(fPortAudioIns, fPortAudioOuts, sampleCount, midiEvents.events, midiEvents.count);
            #else
             fPlugin.run(fPortAudioIns, fPortAudioOuts, sampleCount);
            #endif
@@ -1133,9 +1142,13 @@ private:
     // Temporary data
     float* fLastControlValues;
     double fSampleRate;
-   #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-    MidiEvent fMidiEvents[kMaxMidiEvents];
-   #endif
+
+    // Parameter indexes by direction, so the run loop does not scan every parameter
+    uint32_t* fInputParameterIndexes;
+    uint32_t  fInputParameterCount;
+    uint32_t* fOutputParameterIndexes;
+    uint32_t  fOutputParameterCount;
+    uint32_t  fBypassParameterIndex;
    #if DISTRHO_PLUGIN_WANT_TIMEPOS
     TimePosition fTimePosition;
 
@@ -1327,18 +1340,14 @@ private:
     {
         float curValue;
 
-        for (uint32_t i=0, count=fPlugin.getParameterCount(); i < count; ++i)
+        // NOTE: host is responsible for auto-updating control port buffers of triggers
+        for (uint32_t i=0; i < fOutputParameterCount; ++i)
         {
-            if (fPlugin.isParameterOutput(i))
-            {
-                curValue = fLastControlValues[i] = fPlugin.getParameterValue(i);
+            const uint32_t index = fOutputParameterIndexes[i];
 
-                setPortControlValue(i, curValue);
-            }
-            else if ((fPlugin.getParameterHints(i) & kParameterIsTrigger) == kParameterIsTrigger)
-            {
-                // NOTE: host is responsible for auto-updating control port buffers
-            }
+            curValue = fLastControlValues[index] = fPlugin.getParameterValue(index);
+
+            setPortControlValue(index, curValue);
         }
 
        #if DISTRHO_PLUGIN_WANT_LATENCY
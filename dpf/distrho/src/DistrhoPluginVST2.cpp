@@ -398,6 +398,9 @@ public:
         : fPlugin(this, writeMidiCallback, requestParameterValueChangeCallback, nullptr),
           fAudioMaster(audioMaster),
           fEffect(effect)
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        , fMidiEvents(fPlugin.getMidiEventArena())
+#endif
     {
         std::memset(fProgramName, 0, sizeof(fProgramName));
         std::strcpy(fProgramName, "Default");
@@ -413,7 +416,7 @@ public:
         }
 
 #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-        fMidiEventCount = 0;
+        fMidiEvents.clear();
 #endif
 
 #if DISTRHO_PLUGIN_HAS_UI
@@ -560,7 +563,7 @@ public:
             if (value != 0)
             {
 #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-                fMidiEventCount = 0;
+                fMidiEvents.clear();
 
                 // tell host we want MIDI events
                 hostCallback(VST_HOST_OPCODE_06);
@@ -887,15 +890,16 @@ public:
                         break;
                     if (vstEvent->type != 1)
                         continue;
-                    if (fMidiEventCount >= kMaxMidiEvents)
-                        break;
 
                     const VstMidiEvent& vstMidiEvent(events->events[i]->midi);
 
-                    MidiEvent& midiEvent(fMidiEvents[fMidiEventCount++]);
+                    MidiEvent midiEvent;
                     midiEvent.frame  = vstMidiEvent.deltaFrames;
                     midiEvent.size   = 3;
                     std::memcpy(midiEvent.data, vstMidiEvent.midiData, sizeof(uint8_t)*3);
+
+                    if (! fMidiEvents.append(midiEvent))
+                        break;
                 }
             }
             break;
@@ -1079,29 +1083,29 @@ public:
 
 #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
 # if DISTRHO_PLUGIN_HAS_UI
-        if (fMidiEventCount != kMaxMidiEvents && fNotesRingBuffer.isDataAvailableForReading())
+        if (! fMidiEvents.isFull() && fNotesRingBuffer.isDataAvailableForReading())
         {
             uint8_t midiData[3];
-            uint32_t frame = fMidiEventCount != 0 ? fMidiEvents[fMidiEventCount-1].frame : 0;
+            MidiEvent midiEvent;
+            midiEvent.frame = fMidiEvents.count != 0 ? fMidiEvents.events[fMidiEvents.count-1].frame : 0;
+            midiEvent.size  = 3;
 
             while (fNotesRingBuffer.isDataAvailableForReading())
             {
                 if (! fNotesRingBuffer.readCustomData(midiData, 3))
                     break;
 
-                MidiEvent& midiEvent(fMidiEvents[fMidiEventCount++]);
-                midiEvent.frame = frame;
-                midiEvent.size  = 3;
                 std::memcpy(midiEvent.data, midiData, 3);
+                fMidiEvents.append(midiEvent);
 
-                if (fMidiEventCount == kMaxMidiEvents)
+                if (fMidiEvents.isFull())
                     break;
             }
         }
 # endif
 
-        fPlugin.run(inputs, outputs, sampleFrames, fMidiEvents, fMidiEventCount);
-        fMidiEventCount = 0;
+        fPlugin.run(inputs, outputs, sampleFrames, fMidiEvents.events, fMidiEvents.count);
+        fMidiEvents.clear();
 #else
         fPlugin.run(inputs, outputs, sampleFrames);
 #endif
@@ -1125,8 +1129,7 @@ private:
     char fProgramName[32];
 
 #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-    uint32_t  fMidiEventCount;
-    MidiEvent fMidiEvents[kMaxMidiEvents];
+    MidiEventArena& fMidiEvents;
 #endif
 
 #if DISTRHO_PLUGIN_WANT_TIMEPOS
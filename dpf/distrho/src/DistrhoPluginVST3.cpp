@@ -317,96 +317,97 @@ class PluginVst3
                 v3_event_poly_pressure polyPressure;
                 uint8_t midi[3];
             };
-        } eventListStorage[kMaxMidiEvents];
+        };
 
         struct InputEvent {
             int32_t sampleOffset;
-            const InputEventStorage* storage;
-            InputEvent* next;
-        } eventList[kMaxMidiEvents];
+            InputEventStorage storage;
+        };
+
+        /* Events are stored in the order they are received, as a sequence of runs sorted by sample offset.
+         * Host events and the points of each MIDI CC parameter queue are already sorted, so there are only a few runs,
+         * which are merged when converting to MIDI; ties are resolved in order of arrival.
+         */
+        InputEvent* eventList;
+        uint32_t* runStarts;
+        uint32_t* runPositions;
+        uint32_t* runHeap;
+        uint32_t capacity;
+        uint32_t numUsed;
+        uint32_t numRuns;
+
+        InputEventList() noexcept
+            : eventList(nullptr),
+              runStarts(nullptr),
+              runPositions(nullptr),
+              runHeap(nullptr),
+              capacity(0),
+              numUsed(0),
+              numRuns(0) {}
+
+        ~InputEventList() noexcept
+        {
+            delete[] eventList;
+            delete[] runStarts;
+            delete[] runPositions;
+            delete[] runHeap;
+        }
+
+        // not realtime safe, must not be called while processing
+        void resize(const uint32_t newCapacity)
+        {
+            if (newCapacity <= capacity)
+                return;
 
-        uint16_t numUsed;
-        int32_t firstSampleOffset;
-        int32_t lastSampleOffset;
-        InputEvent* firstEvent;
-        InputEvent* lastEvent;
+            delete[] eventList;
+            delete[] runStarts;
+            delete[] runPositions;
+            delete[] runHeap;
+            eventList = new InputEvent[newCapacity];
+            runStarts = new uint32_t[newCapacity];
+            runPositions = new uint32_t[newCapacity];
+            runHeap = new uint32_t[newCapacity];
+            capacity = newCapacity;
+            init();
+        }
 
         void init()
         {
             numUsed = 0;
-            firstSampleOffset = lastSampleOffset = 0;
-            firstEvent = nullptr;
+            numRuns = 0;
         }
 
-        uint32_t convert(MidiEvent midiEvents[kMaxMidiEvents]) const noexcept
+        void convert(MidiEventArena& midiEvents) noexcept
         {
-            uint32_t count = 0;
+            if (numRuns <= 1)
+            {
+                for (uint32_t i = 0; i < numUsed; ++i)
+                    convertEvent(midiEvents, eventList[i]);
+                return;
+            }
 
-            for (const InputEvent* event = firstEvent; event != nullptr; event = event->next)
+            // k-way merge of all runs, using a binary min-heap of run indexes
+            for (uint32_t r = 0; r < numRuns; ++r)
             {
-                MidiEvent& midiEvent(midiEvents[count++]);
-                midiEvent.frame = event->sampleOffset;
+                runPositions[r] = runStarts[r];
+                runHeap[r] = r;
+            }
 
-                const InputEventStorage& eventStorage(*event->storage);
+            uint32_t heapSize = numRuns;
 
-                switch (eventStorage.type)
-                {
-                case NoteOn:
-                    midiEvent.size = 3;
-                    midiEvent.data[0] = 0x90 | (eventStorage.noteOn.channel & 0xf);
-                    midiEvent.data[1] = eventStorage.noteOn.pitch;
-                    midiEvent.data[2] = std::max(0, std::min(127, (int)(eventStorage.noteOn.velocity * 127)));
-                    midiEvent.data[3] = 0;
-                    break;
-                case NoteOff:
-                    midiEvent.size = 3;
-                    midiEvent.data[0] = 0x80 | (eventStorage.noteOff.channel & 0xf);
-                    midiEvent.data[1] = eventStorage.noteOff.pitch;
-                    midiEvent.data[2] = std::max(0, std::min(127, (int)(eventStorage.noteOff.velocity * 127)));
-                    midiEvent.data[3] = 0;
-                    break;
-                /* TODO
-                case SysexData:
-                    break;
-                */
-                case PolyPressure:
-                    midiEvent.size = 3;
-                    midiEvent.data[0] = 0xA0 | (eventStorage.polyPressure.channel & 0xf);
-                    midiEvent.data[1] = eventStorage.polyPressure.pitch;
-                    midiEvent.data[2] = std::max(0, std::min(127, (int)(eventStorage.polyPressure.pressure * 127)));
-                    midiEvent.data[3] = 0;
-                    break;
-                case CC_Normal:
-                    midiEvent.size = 3;
-                    midiEvent.data[0] = 0xB0 | (eventStorage.midi[0] & 0xf);
-                    midiEvent.data[1] = eventStorage.midi[1];
-                    midiEvent.data[2] = eventStorage.midi[2];
-                    break;
-                case CC_ChannelPressure:
-                    midiEvent.size = 2;
-                    midiEvent.data[0] = 0xD0 | (eventStorage.midi[0] & 0xf);
-                    midiEvent.data[1] = eventStorage.midi[1];
-                    midiEvent.data[2] = 0;
-                    break;
-                case CC_Pitchbend:
-                    midiEvent.size = 3;
-                    midiEvent.data[0] = 0xE0 | (eventStorage.midi[0] & 0xf);
-                    midiEvent.data[1] = eventStorage.midi[1];
-                    midiEvent.data[2] = eventStorage.midi[2];
-                    break;
-                case UI_MIDI:
-                    midiEvent.size = 3;
-                    midiEvent.data[0] = eventStorage.midi[0];
-                    midiEvent.data[1] = eventStorage.midi[1];
-                    midiEvent.data[2] = eventStorage.midi[2];
-                    break;
-                default:
-                    midiEvent.size = 0;
-                    break;
-                }
-            }
+            for (uint32_t i = heapSize / 2; i-- != 0;)
+                siftDown(i, heapSize);
+
+            while (heapSize != 0)
+            {
+                const uint32_t r = runHeap[0];
+                convertEvent(midiEvents, eventList[runPositions[r]]);
 
-            return count;
+                if (++runPositions[r] == getRunEnd(r))
+                    runHeap[0] = runHeap[--heapSize];
+
+                siftDown(0, heapSize);
+            }
         }
 
         bool appendEvent(const v3_event& event) noexcept
@@ -423,7 +424,7 @@ class PluginVst3
                 return false;
             }
 
-            InputEventStorage& eventStorage(eventListStorage[numUsed]);
+            InputEventStorage& eventStorage(eventList[numUsed].storage);
 
             switch (event.type)
             {
@@ -447,15 +448,13 @@ class PluginVst3
                 return false;
             }
 
-            eventList[numUsed].sampleOffset = event.sample_offset;
-            eventList[numUsed].storage = &eventStorage;
-
-            return placeSorted(event.sample_offset);
+            return push(event.sample_offset);
         }
 
+        // when the list is full, the value of the latest event of the same controller is updated instead
         bool appendCC(const int32_t sampleOffset, v3_param_id paramId, const double normalized) noexcept
         {
-            InputEventStorage& eventStorage(eventListStorage[numUsed]);
+            InputEventStorage eventStorage;
 
             paramId -= kVst3InternalParameterMidiCC_start;
 
@@ -482,98 +481,167 @@ class PluginVst3
 
             eventStorage.midi[0] = paramId / 130;
 
-            eventList[numUsed].sampleOffset = sampleOffset;
-            eventList[numUsed].storage = &eventStorage;
+            if (numUsed == capacity)
+            {
+                InputEvent* latest = nullptr;
+
+                for (uint32_t i = 0; i < numUsed; ++i)
+                {
+                    InputEvent& other(eventList[i]);
+
+                    if (other.storage.type != eventStorage.type || other.storage.midi[0] != eventStorage.midi[0])
+                        continue;
+                    if (eventStorage.type == CC_Normal && other.storage.midi[1] != cc)
+                        continue;
+                    if (latest != nullptr && other.sampleOffset < latest->sampleOffset)
+                        continue;
+
+                    latest = &other;
+                }
+
+                if (latest != nullptr)
+                {
+                    latest->storage.midi[1] = eventStorage.midi[1];
+                    latest->storage.midi[2] = eventStorage.midi[2];
+                }
+
+                return true;
+            }
 
-            return placeSorted(sampleOffset);
+            eventList[numUsed].storage = eventStorage;
+
+            return push(sampleOffset);
         }
 
        #if DISTRHO_PLUGIN_HAS_UI
         // NOTE always runs first
         bool appendFromUI(const uint8_t midiData[3])
         {
-            InputEventStorage& eventStorage(eventListStorage[numUsed]);
+            InputEventStorage& eventStorage(eventList[numUsed].storage);
 
             eventStorage.type = UI_MIDI;
             std::memcpy(eventStorage.midi, midiData, sizeof(uint8_t)*3);
 
-            InputEvent* const event = &eventList[numUsed];
+            return push(0);
+        }
+       #endif
 
-            event->sampleOffset = 0;
-            event->storage = &eventStorage;
-            event->next = nullptr;
+    private:
+        // event data must already be in place, starts a new run if the offset goes backwards
+        bool push(const int32_t sampleOffset) noexcept
+        {
+            if (numUsed == 0 || sampleOffset < eventList[numUsed - 1].sampleOffset)
+                runStarts[numRuns++] = numUsed;
 
-            if (numUsed == 0)
-            {
-                firstEvent = lastEvent = event;
-            }
-            else
-            {
-                lastEvent->next = event;
-                lastEvent = event;
-            }
+            eventList[numUsed].sampleOffset = sampleOffset;
 
-            return ++numUsed == kMaxMidiEvents;
+            return ++numUsed == capacity;
         }
-       #endif
 
-    private:
-        bool placeSorted(const int32_t sampleOffset) noexcept
+        uint32_t getRunEnd(const uint32_t run) const noexcept
         {
-            InputEvent* const event = &eventList[numUsed];
+            return run + 1 < numRuns ? runStarts[run + 1] : numUsed;
+        }
 
-            // initialize
-            if (numUsed == 0)
-            {
-                firstSampleOffset = lastSampleOffset = sampleOffset;
-                firstEvent = lastEvent = event;
-                event->next = nullptr;
-            }
-            // push to the back
-            else if (sampleOffset >= lastSampleOffset)
-            {
-                lastSampleOffset = sampleOffset;
-                lastEvent->next = event;
-                lastEvent = event;
-                event->next = nullptr;
-            }
-            // push to the front
-            else if (sampleOffset < firstSampleOffset)
-            {
-                firstSampleOffset = sampleOffset;
-                event->next = firstEvent;
-                firstEvent = event;
-            }
-            // find place in between events
-            else
+        // compares the current events of two runs, earlier runs go first on equal offsets
+        bool isRunBefore(const uint32_t run1, const uint32_t run2) const noexcept
+        {
+            const int32_t offset1 = eventList[runPositions[run1]].sampleOffset;
+            const int32_t offset2 = eventList[runPositions[run2]].sampleOffset;
+
+            return offset1 < offset2 || (offset1 == offset2 && run1 < run2);
+        }
+
+        void siftDown(uint32_t index, const uint32_t heapSize) noexcept
+        {
+            for (;;)
             {
-                // keep reference out of the loop so we can check validity afterwards
-                InputEvent* event2 = firstEvent;
+                const uint32_t left = index * 2 + 1;
 
-                // iterate all events
-                for (; event2 != nullptr; event2 = event2->next)
-                {
-                    // if offset is higher than iterated event, stop and insert in-between
-                    if (sampleOffset > event2->sampleOffset)
-                        break;
+                if (left >= heapSize)
+                    return;
 
-                    // if offset matches, find the last event with the same offset so we can push after it
-                    if (sampleOffset == event2->sampleOffset)
-                    {
-                        event2 = event2->next;
-                        for (; event2 != nullptr && sampleOffset == event2->sampleOffset; event2 = event2->next) {}
-                        break;
-                    }
-                }
+                uint32_t child = left;
+
+                if (left + 1 < heapSize && isRunBefore(runHeap[left + 1], runHeap[left]))
+                    child = left + 1;
 
-                DISTRHO_SAFE_ASSERT_RETURN(event2 != nullptr, true);
+                if (! isRunBefore(runHeap[child], runHeap[index]))
+                    return;
 
-                event->next = event2->next;
-                event2->next = event;
+                std::swap(runHeap[child], runHeap[index]);
+                index = child;
             }
+        }
+
+        static void convertEvent(MidiEventArena& midiEvents, const InputEvent& event) noexcept
+        {
+            MidiEvent midiEvent;
+            midiEvent.frame = event.sampleOffset;
+            midiEvent.dataExt = nullptr;
+
+            const InputEventStorage& eventStorage(event.storage);
 
-            return ++numUsed == kMaxMidiEvents;
+            switch (eventStorage.type)
+            {
+            case NoteOn:
+                midiEvent.size = 3;
+                midiEvent.data[0] = 0x90 | (eventStorage.noteOn.channel & 0xf);
+                midiEvent.data[1] = eventStorage.noteOn.pitch;
+                midiEvent.data[2] = std::max(0, std::min(127, (int)(eventStorage.noteOn.velocity * 127)));
+                midiEvent.data[3] = 0;
+                break;
+            case NoteOff:
+                midiEvent.size = 3;
+                midiEvent.data[0] = 0x80 | (eventStorage.noteOff.channel & 0xf);
+                midiEvent.data[1] = eventStorage.noteOff.pitch;
+                midiEvent.data[2] = std::max(0, std::min(127, (int)(eventStorage.noteOff.velocity * 127)));
+                midiEvent.data[3] = 0;
+                break;
+            /* TODO
+            case SysexData:
+                break;
+            */
+            case PolyPressure:
+                midiEvent.size = 3;
+                midiEvent.data[0] = 0xA0 | (eventStorage.polyPressure.channel & 0xf);
+                midiEvent.data[1] = eventStorage.polyPressure.pitch;
+                midiEvent.data[2] = std::max(0, std::min(127, (int)(eventStorage.polyPressure.pressure * 127)));
+                midiEvent.data[3] = 0;
+                break;
+            case CC_Normal:
+                midiEvent.size = 3;
+                midiEvent.data[0] = 0xB0 | (eventStorage.midi[0] & 0xf);
+                midiEvent.data[1] = eventStorage.midi[1];
+                midiEvent.data[2] = eventStorage.midi[2];
+                break;
+            case CC_ChannelPressure:
+                midiEvent.size = 2;
+                midiEvent.data[0] = 0xD0 | (eventStorage.midi[0] & 0xf);
+                midiEvent.data[1] = eventStorage.midi[1];
+                midiEvent.data[2] = 0;
+                break;
+            case CC_Pitchbend:
+                midiEvent.size = 3;
+                midiEvent.data[0] = 0xE0 | (eventStorage.midi[0] & 0xf);
+                midiEvent.data[1] = eventStorage.midi[1];
+                midiEvent.data[2] = eventStorage.midi[2];
+                break;
+            case UI_MIDI:
+                midiEvent.size = 3;
+                midiEvent.data[0] = eventStorage.midi[0];
+                midiEvent.data[1] = eventStorage.midi[1];
+                midiEvent.data[2] = eventStorage.midi[2];
+                break;
+            default:
+                midiEvent.size = 0;
+                break;
+            }
+
+            midiEvents.append(midiEvent);
         }
+
+        DISTRHO_DECLARE_NON_COPYABLE(InputEventList)
     } inputEventList;
    #endif // DISTRHO_PLUGIN_WANT_MIDI_INPUT
 
@@ -615,6 +683,10 @@ public:
         DISTRHO_SAFE_ASSERT(isComponent);
        #endif
 
+       #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        inputEventList.resize(fPlugin.getMidiEventArena().capacity);
+       #endif
+
        #if DISTRHO_PLUGIN_NUM_INPUTS > 0
         std::memset(fEnabledInputs, 0, sizeof(fEnabledInputs));
         fillInBusInfoDetails<true>();
@@ -703,7 +775,7 @@ public:
         return ranges.getFixedAndNormalizedValue(plain);
     }
 
-    void _setNormalizedPluginParameterValue(const uint32_t index, const double normalized)
+    void _setNormalizedPluginParameterValue(const uint32_t index, const double normalized, const int32_t offset = 0)
     {
         const ParameterRanges& ranges(fPlugin.getParameterRanges(index));
         const uint32_t hints = fPlugin.getParameterHints(index);
@@ -747,8 +819,17 @@ public:
         }
       #endif
 
-        if (!fPlugin.isParameterOutputOrTrigger(index))
-            fPlugin.setParameterValue(index, value);
+        if (fPlugin.isParameterOutputOrTrigger(index))
+            return;
+
+       #if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+        fPlugin.addParameterEvent(static_cast<uint32_t>(std::max(0, offset)), index, value);
+       #else
+        // unused
+        (void)offset;
+
+        fPlugin.setParameterValue(index, value);
+       #endif
     }
 
     // ----------------------------------------------------------------------------------------------------------------
@@ -1330,6 +1411,10 @@ public:
         fPlugin.setSampleRate(setup->sample_rate, true);
         fPlugin.setBufferSize(setup->max_block_size, true);
 
+       #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        inputEventList.resize(fPlugin.getMidiEventArena().capacity);
+       #endif
+
       #if DPF_VST3_USES_SEPARATE_CONTROLLER
         fCachedParameterValues[kVst3InternalParameterBufferSize] = setup->max_block_size;
         fParameterValuesChangedDuringProcessing[kVst3InternalParameterBufferSize] = true;
@@ -1541,18 +1626,15 @@ public:
                 {
                    #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
                     // if there are any MIDI CC events as parameter changes, handle them here
-                    if (canAppendMoreEvents && rindex >= kVst3InternalParameterMidiCC_start && rindex <= kVst3InternalParameterMidiCC_end)
+                    // NOTE these are still handled when the event list is full, so the latest values are kept
+                    if (rindex >= kVst3InternalParameterMidiCC_start && rindex <= kVst3InternalParameterMidiCC_end)
                     {
                         for (int32_t j = 0, pcount = v3_cpp_obj(queue)->get_point_count(queue); j < pcount; ++j)
                         {
                             if (v3_cpp_obj(queue)->get_point(queue, j, &offset, &normalized) != V3_OK)
                                 break;
 
-                            if (inputEventList.appendCC(offset, rindex, normalized))
-                            {
-                                canAppendMoreEvents = false;
-                                break;
-                            }
+                            inputEventList.appendCC(offset, rindex, normalized);
                         }
                     }
                    #endif
@@ -1560,6 +1642,18 @@ public:
                 }
                #endif
 
+                const uint32_t index = rindex - kVst3InternalParameterCount;
+
+               #if DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
+                // pass all parameter changes to the plugin with their sample offset
+                for (int32_t j = 0, pcount = v3_cpp_obj(queue)->get_point_count(queue); j < pcount; ++j)
+                {
+                    if (v3_cpp_obj(queue)->get_point(queue, j, &offset, &normalized) != V3_OK)
+                        break;
+
+                    _setNormalizedPluginParameterValue(index, normalized, offset);
+                }
+               #else
                 if (v3_cpp_obj(queue)->get_point_count(queue) <= 0)
                     continue;
 
@@ -1570,14 +1664,16 @@ public:
                 if (offset != 0)
                     continue;
 
-                const uint32_t index = rindex - kVst3InternalParameterCount;
                 _setNormalizedPluginParameterValue(index, normalized);
+               #endif
             }
         }
 
        #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-        const uint32_t midiEventCount = inputEventList.convert(fMidiEvents);
-        fPlugin.run(inputs, outputs, data->nframes, fMidiEvents, midiEventCount);
+        MidiEventArena& midiEvents(fPlugin.getMidiEventArena());
+        midiEvents.clear();
+        inputEventList.convert(midiEvents);
+        fPlugin.run(inputs, outputs, data->nframes, midiEvents.events, midiEvents.count);
        #else
         fPlugin.run(inputs, outputs, data->nframes);
        #endif
@@ -1586,6 +1682,7 @@ public:
         fHostEventOutputHandle = nullptr;
        #endif
 
+       #if ! DISTRHO_PLUGIN_WANT_PARAMETER_EVENTS
         // if there are any parameter changes after frame 0, set them here
         if (v3_param_changes** const inparamsptr = data->input_params)
         {
@@ -1620,6 +1717,7 @@ public:
                 _setNormalizedPluginParameterValue(index, normalized);
             }
         }
+       #endif
 
         updateParametersFromProcessing(data->output_params, data->nframes - 1);
         return V3_OK;
@@ -2442,7 +2540,6 @@ private:
     uint32_t fLastKnownLatency;
    #endif
   #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
-    MidiEvent fMidiEvents[kMaxMidiEvents];
    #if DISTRHO_PLUGIN_HAS_UI
     SmallStackRingBuffer fNotesRingBuffer;
    #endif
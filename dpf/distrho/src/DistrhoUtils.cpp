@@ -76,7 +76,9 @@ const char* getBinaryFilename()
 
 const char* getPluginFormatName() noexcept
 {
-#if defined(DISTRHO_PLUGIN_TARGET_CARLA)
+#if defined(DISTRHO_PLUGIN_TARGET_BENCH)
+    return "Bench";
+#elif defined(DISTRHO_PLUGIN_TARGET_CARLA)
     return "Carla";
 #elif defined(DISTRHO_PLUGIN_TARGET_JACK)
    #if defined(DISTRHO_OS_WASM)
@@ -20,13 +20,32 @@
 #include <cmath>
 
 static const float kAMP_DB = 8.656170245f;
-static const float kDC_ADD = 1e-30f;
 static const float kPI     = 3.141592654f;
 
+// frames filtered at once, into buffers on the stack
+static const uint32_t kBlockSize = 64;
+
 START_NAMESPACE_DISTRHO
 
 // -----------------------------------------------------------------------
 
+// Smoothed dB values ramp linearly within a block,
+// which is a constant per-frame ratio for the linear gain.
+static inline
+void setupGainRamp(const float* const ramp, const uint32_t frames, float& gain, float& ratio)
+{
+    if (ramp == nullptr)
+    {
+        ratio = 1.0f;
+        return;
+    }
+
+    gain  = std::exp(ramp[0] / kAMP_DB);
+    ratio = frames > 1 ? std::exp((ramp[1] - ramp[0]) / kAMP_DB) : 1.0f;
+}
+
+// -----------------------------------------------------------------------
+
 DistrhoPlugin3BandEQ::DistrhoPlugin3BandEQ()
     : Plugin(paramCount, 1, 0) // 1 program, 0 states
 {
@@ -52,7 +71,7 @@ void DistrhoPlugin3BandEQ::initParameter(uint32_t index, Parameter& parameter)
     switch (index)
     {
     case paramLow:
-        parameter.hints      = kParameterIsAutomatable;
+        parameter.hints      = kParameterIsAutomatable|kParameterIsSmoothed;
         parameter.name       = "Low";
         parameter.symbol     = "low";
         parameter.unit       = "dB";
@@ -62,7 +81,7 @@ void DistrhoPlugin3BandEQ::initParameter(uint32_t index, Parameter& parameter)
         break;
 
     case paramMid:
-        parameter.hints      = kParameterIsAutomatable;
+        parameter.hints      = kParameterIsAutomatable|kParameterIsSmoothed;
         parameter.name       = "Mid";
         parameter.symbol     = "mid";
         parameter.unit       = "dB";
@@ -72,7 +91,7 @@ void DistrhoPlugin3BandEQ::initParameter(uint32_t index, Parameter& parameter)
         break;
 
     case paramHigh:
-        parameter.hints      = kParameterIsAutomatable;
+        parameter.hints      = kParameterIsAutomatable|kParameterIsSmoothed;
         parameter.name       = "High";
         parameter.symbol     = "high";
         parameter.unit       = "dB";
@@ -82,7 +101,7 @@ void DistrhoPlugin3BandEQ::initParameter(uint32_t index, Parameter& parameter)
         break;
 
     case paramMaster:
-        parameter.hints      = kParameterIsAutomatable;
+        parameter.hints      = kParameterIsAutomatable|kParameterIsSmoothed;
         parameter.name       = "Master";
         parameter.symbol     = "master";
         parameter.unit       = "dB";
@@ -174,6 +193,7 @@ void DistrhoPlugin3BandEQ::setParameterValue(uint32_t index, float value)
         xLP  = std::exp(-2.0f * kPI * freqLP / (float)getSampleRate());
         a0LP = 1.0f - xLP;
         b1LP = -xLP;
+        fFilter.setCoefficients(a0LP, b1LP, a0HP, b1HP);
         break;
     case paramMidHighFreq:
         fMidHighFreq = std::fmax(value, fLowMidFreq);
@@ -181,6 +201,7 @@ void DistrhoPlugin3BandEQ::setParameterValue(uint32_t index, float value)
         xHP  = std::exp(-2.0f * kPI * freqHP / (float)getSampleRate());
         a0HP = 1.0f - xHP;
         b1HP = -xHP;
+        fFilter.setCoefficients(a0LP, b1LP, a0HP, b1HP);
         break;
     }
 }
@@ -222,35 +243,69 @@ void DistrhoPlugin3BandEQ::activate()
     xHP  = std::exp(-2.0f * kPI * freqHP / sr);
     a0HP = 1.0f - xHP;
     b1HP = -xHP;
+
+    fFilter.setCoefficients(a0LP, b1LP, a0HP, b1HP);
 }
 
 void DistrhoPlugin3BandEQ::deactivate()
 {
-    out1LP = out2LP = out1HP = out2HP = 0.0f;
-    tmp1LP = tmp2LP = tmp1HP = tmp2HP = 0.0f;
+    fFilter.reset();
 }
 
 void DistrhoPlugin3BandEQ::run(const float** inputs, float** outputs, uint32_t frames)
 {
-    const float* in1  = inputs[0];
-    const float* in2  = inputs[1];
-    float*       out1 = outputs[0];
-    float*       out2 = outputs[1];
+    const ScopedDenormalDisable sdd;
+
+    const float* const lowRamp  = getParameterRamp(paramLow);
+    const float* const midRamp  = getParameterRamp(paramMid);
+    const float* const highRamp = getParameterRamp(paramHigh);
+    const float* const outRamp  = getParameterRamp(paramMaster);
+    const bool ramping = lowRamp != nullptr || midRamp != nullptr || highRamp != nullptr || outRamp != nullptr;
+
+    float lowGain = lowVol, midGain = midVol, highGain = highVol, outGain = outVol;
+    float lowRatio, midRatio, highRatio, outRatio;
+
+    setupGainRamp(lowRamp,  frames, lowGain,  lowRatio);
+    setupGainRamp(midRamp,  frames, midGain,  midRatio);
+    setupGainRamp(highRamp, frames, highGain, highRatio);
+    setupGainRamp(outRamp,  frames, outGain,  outRatio);
+
+    float lowBuf[2][kBlockSize];
+    float highBuf[2][kBlockSize];
+    float* const low[2]  = { lowBuf[0],  lowBuf[1]  };
+    float* const high[2] = { highBuf[0], highBuf[1] };
 
-    for (uint32_t i=0; i < frames; ++i)
+    for (uint32_t offset = 0; offset < frames; offset += kBlockSize)
     {
-        tmp1LP = a0LP * in1[i] - b1LP * tmp1LP + kDC_ADD;
-        tmp2LP = a0LP * in2[i] - b1LP * tmp2LP + kDC_ADD;
-        out1LP = tmp1LP - kDC_ADD;
-        out2LP = tmp2LP - kDC_ADD;
-
-        tmp1HP = a0HP * in1[i] - b1HP * tmp1HP + kDC_ADD;
-        tmp2HP = a0HP * in2[i] - b1HP * tmp2HP + kDC_ADD;
-        out1HP = in1[i] - tmp1HP - kDC_ADD;
-        out2HP = in2[i] - tmp2HP - kDC_ADD;
-
-        out1[i] = (out1LP*lowVol + (in1[i] - out1LP - out1HP)*midVol + out1HP*highVol) * outVol;
-        out2[i] = (out2LP*lowVol + (in2[i] - out2LP - out2HP)*midVol + out2HP*highVol) * outVol;
+        const uint32_t count = std::min(frames - offset, kBlockSize);
+        const float* const in1  = inputs[0] + offset;
+        const float* const in2  = inputs[1] + offset;
+        float* const       out1 = outputs[0] + offset;
+        float* const       out2 = outputs[1] + offset;
+        const float* const ins[2] = { in1, in2 };
+
+        fFilter.process(ins, low, high, count);
+
+        if (! ramping)
+        {
+            for (uint32_t i=0; i < count; ++i)
+            {
+                out1[i] = (low[0][i]*lowVol + (in1[i] - low[0][i] - high[0][i])*midVol + high[0][i]*highVol) * outVol;
+                out2[i] = (low[1][i]*lowVol + (in2[i] - low[1][i] - high[1][i])*midVol + high[1][i]*highVol) * outVol;
+            }
+            continue;
+        }
+
+        for (uint32_t i=0; i < count; ++i)
+        {
+            out1[i] = (low[0][i]*lowGain + (in1[i] - low[0][i] - high[0][i])*midGain + high[0][i]*highGain) * outGain;
+            out2[i] = (low[1][i]*lowGain + (in2[i] - low[1][i] - high[1][i])*midGain + high[1][i]*highGain) * outGain;
+
+            lowGain  *= lowRatio;
+            midGain  *= midRatio;
+            highGain *= highRatio;
+            outGain  *= outRatio;
+        }
     }
 }
 
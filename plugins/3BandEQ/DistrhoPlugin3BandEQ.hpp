@@ -19,6 +19,7 @@
 #define DISTRHO_PLUGIN_3BANDEQ_HPP_INCLUDED
 
 #include "DistrhoPlugin.hpp"
+#include "DistrhoThreeBandFilter.hpp"
 
 START_NAMESPACE_DISTRHO
 
@@ -111,8 +112,7 @@ private:
     float xLP, a0LP, b1LP;
     float xHP, a0HP, b1HP;
 
-    float out1LP, out2LP, out1HP, out2HP;
-    float tmp1LP, tmp2LP, tmp1HP, tmp2HP;
+    ThreeBandFilter<DISTRHO_PLUGIN_NUM_INPUTS> fFilter;
 
     DISTRHO_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DistrhoPlugin3BandEQ)
 };
@@ -20,9 +20,11 @@
 #include <cmath>
 
 static const float kAMP_DB = 8.656170245f;
-static const float kDC_ADD = 1e-30f;
 static const float kPI     = 3.141592654f;
 
+// frames filtered at once, into buffers on the stack
+static const uint32_t kBlockSize = 64;
+
 START_NAMESPACE_DISTRHO
 
 // -----------------------------------------------------------------------
@@ -160,6 +162,17 @@ void DistrhoPlugin3BandSplitter::initParameter(uint32_t index, Parameter& parame
         parameter.ranges.min = 1000.0f;
         parameter.ranges.max = 20000.0f;
         break;
+
+    case paramCrossoverMode:
+        // 24 dB/oct Linkwitz-Riley instead of the original 6 dB/oct filters, off by default for compatibility
+        parameter.hints      = kParameterIsBoolean;
+        parameter.name       = "LR4 Crossover";
+        parameter.symbol     = "lr4";
+        parameter.unit       = "";
+        parameter.ranges.def = 0.0f;
+        parameter.ranges.min = 0.0f;
+        parameter.ranges.max = 1.0f;
+        break;
     }
 }
 
@@ -209,6 +222,8 @@ float DistrhoPlugin3BandSplitter::getParameterValue(uint32_t index) const
         return fLowMidFreq;
     case paramMidHighFreq:
         return fMidHighFreq;
+    case paramCrossoverMode:
+        return fCrossoverMode;
     default:
         return 0.0f;
     }
@@ -243,6 +258,8 @@ void DistrhoPlugin3BandSplitter::setParameterValue(uint32_t index, float value)
         xLP  = std::exp(-2.0f * kPI * freqLP / (float)getSampleRate());
         a0LP = 1.0f - xLP;
         b1LP = -xLP;
+        fFilter.setCoefficients(a0LP, b1LP, a0HP, b1HP);
+        fCrossover.setFrequencies(freqLP, freqHP, getSampleRate());
         break;
     case paramMidHighFreq:
         fMidHighFreq = std::fmax(value, fLowMidFreq);
@@ -250,6 +267,14 @@ void DistrhoPlugin3BandSplitter::setParameterValue(uint32_t index, float value)
         xHP  = std::exp(-2.0f * kPI * freqHP / (float)getSampleRate());
         a0HP = 1.0f - xHP;
         b1HP = -xHP;
+        fFilter.setCoefficients(a0LP, b1LP, a0HP, b1HP);
+        fCrossover.setFrequencies(freqLP, freqHP, getSampleRate());
+        break;
+    case paramCrossoverMode:
+        // do not carry over stale state from the last time this mode was used
+        if ((value > 0.5f) != (fCrossoverMode > 0.5f))
+            fCrossover.reset();
+        fCrossoverMode = value;
         break;
     }
 }
@@ -266,6 +291,7 @@ void DistrhoPlugin3BandSplitter::loadProgram(uint32_t index)
     fMaster = 0.0f;
     fLowMidFreq = 220.0f;
     fMidHighFreq = 2000.0f;
+    fCrossoverMode = 0.0f;
 
     // Internal stuff
     lowVol = midVol = highVol = outVol = 1.0f;
@@ -291,43 +317,68 @@ void DistrhoPlugin3BandSplitter::activate()
     xHP  = std::exp(-2.0f * kPI * freqHP / sr);
     a0HP = 1.0f - xHP;
     b1HP = -xHP;
+
+    fFilter.setCoefficients(a0LP, b1LP, a0HP, b1HP);
+    fCrossover.setFrequencies(freqLP, freqHP, sr);
 }
 
 void DistrhoPlugin3BandSplitter::deactivate()
 {
-    out1LP = out2LP = out1HP = out2HP = 0.0f;
-    tmp1LP = tmp2LP = tmp1HP = tmp2HP = 0.0f;
+    fFilter.reset();
+    fCrossover.reset();
 }
 
 void DistrhoPlugin3BandSplitter::run(const float** inputs, float** outputs, uint32_t frames)
 {
-    const float* in1  = inputs[0];
-    const float* in2  = inputs[1];
-    float*       out1 = outputs[0];
-    float*       out2 = outputs[1];
-    float*       out3 = outputs[2];
-    float*       out4 = outputs[3];
-    float*       out5 = outputs[4];
-    float*       out6 = outputs[5];
-
-    for (uint32_t i=0; i < frames; ++i)
+    const ScopedDenormalDisable sdd;
+
+    const bool linkwitzRiley = fCrossoverMode > 0.5f;
+
+    float lowBuf[2][kBlockSize];
+    float midBuf[2][kBlockSize];
+    float highBuf[2][kBlockSize];
+    float* const low[2]  = { lowBuf[0],  lowBuf[1]  };
+    float* const mid[2]  = { midBuf[0],  midBuf[1]  };
+    float* const high[2] = { highBuf[0], highBuf[1] };
+
+    for (uint32_t offset = 0; offset < frames; offset += kBlockSize)
     {
-        tmp1LP = a0LP * in1[i] - b1LP * tmp1LP + kDC_ADD;
-        tmp2LP = a0LP * in2[i] - b1LP * tmp2LP + kDC_ADD;
-        out1LP = tmp1LP - kDC_ADD;
-        out2LP = tmp2LP - kDC_ADD;
-
-        tmp1HP = a0HP * in1[i] - b1HP * tmp1HP + kDC_ADD;
-        tmp2HP = a0HP * in2[i] - b1HP * tmp2HP + kDC_ADD;
-        out1HP = in1[i] - tmp1HP - kDC_ADD;
-        out2HP = in2[i] - tmp2HP - kDC_ADD;
-
-        out6[i] = out2HP*highVol * outVol;
-        out5[i] = out1HP*highVol * outVol;
-        out4[i] = (in2[i] - out2LP - out2HP)*midVol * outVol;
-        out3[i] = (in1[i] - out1LP - out1HP)*midVol * outVol;
-        out2[i] = out2LP*lowVol * outVol;
-        out1[i] = out1LP*lowVol * outVol;
+        const uint32_t count = std::min(frames - offset, kBlockSize);
+        const float* const in1  = inputs[0] + offset;
+        const float* const in2  = inputs[1] + offset;
+        float* const       out1 = outputs[0] + offset;
+        float* const       out2 = outputs[1] + offset;
+        float* const       out3 = outputs[2] + offset;
+        float* const       out4 = outputs[3] + offset;
+        float* const       out5 = outputs[4] + offset;
+        float* const       out6 = outputs[5] + offset;
+        const float* const ins[2] = { in1, in2 };
+
+        if (linkwitzRiley)
+        {
+            fCrossover.process(ins, low, mid, high, count);
+        }
+        else
+        {
+            fFilter.process(ins, low, high, count);
+
+            for (uint32_t i=0; i < count; ++i)
+            {
+                mid[0][i] = in1[i] - low[0][i] - high[0][i];
+                mid[1][i] = in2[i] - low[1][i] - high[1][i];
+            }
+        }
+
+        // all bands are in local buffers now, inputs may share buffers with the outputs
+        for (uint32_t i=0; i < count; ++i)
+        {
+            out6[i] = high[1][i]*highVol * outVol;
+            out5[i] = high[0][i]*highVol * outVol;
+            out4[i] = mid[1][i]*midVol * outVol;
+            out3[i] = mid[0][i]*midVol * outVol;
+            out2[i] = low[1][i]*lowVol * outVol;
+            out1[i] = low[0][i]*lowVol * outVol;
+        }
     }
 }
 
@@ -19,6 +19,7 @@
 #define DISTRHO_PLUGIN_3BANDSPLITTER_HPP_INCLUDED
 
 #include "DistrhoPlugin.hpp"
+#include "DistrhoThreeBandFilter.hpp"
 
 START_NAMESPACE_DISTRHO
 
@@ -35,6 +36,7 @@ public:
         paramMaster,
         paramLowMidFreq,
         paramMidHighFreq,
+        paramCrossoverMode,
         paramCount
     };
 
@@ -112,7 +114,7 @@ protected:
     // -------------------------------------------------------------------
 
 private:
-    float fLow, fMid, fHigh, fMaster, fLowMidFreq, fMidHighFreq;
+    float fLow, fMid, fHigh, fMaster, fLowMidFreq, fMidHighFreq, fCrossoverMode;
 
     float lowVol, midVol, highVol, outVol;
     float freqLP, freqHP;
@@ -120,8 +122,8 @@ private:
     float xLP, a0LP, b1LP;
     float xHP, a0HP, b1HP;
 
-    float out1LP, out2LP, out1HP, out2HP;
-    float tmp1LP, tmp2LP, tmp1HP, tmp2HP;
+    ThreeBandFilter<DISTRHO_PLUGIN_NUM_INPUTS> fFilter;
+    LinkwitzRileyCrossover<DISTRHO_PLUGIN_NUM_INPUTS> fCrossover;
 
     DISTRHO_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DistrhoPlugin3BandSplitter)
 };
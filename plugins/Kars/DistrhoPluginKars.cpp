@@ -26,14 +26,23 @@ DistrhoPluginKars::DistrhoPluginKars()
       fSustain(false),
       fRelease(0.01),
       fVolume(75.0f),
+      fDecay(0.0f),
       fSampleRate(getSampleRate()),
-      fBlockStart(0)
+      fBlockStart(0),
+      fNoiseState(2463534242U),
+      fActiveNoteCount(0),
+      fWavetables(nullptr),
+      fWavetablesSize(0)
 {
     for (int i=kMaxNotes; --i >= 0;)
-    {
         fNotes[i].voice = i;
-        fNotes[i].setSampleRate(fSampleRate);
-    }
+
+    allocateWavetables();
+}
+
+DistrhoPluginKars::~DistrhoPluginKars()
+{
+    delete[] fWavetables;
 }
 
 // -----------------------------------------------------------------------
@@ -76,6 +85,15 @@ void DistrhoPluginKars::initParameter(uint32_t index, Parameter& parameter)
         parameter.ranges.min = 0.0f;
         parameter.ranges.max = 100.0f;
         break;
+    case paramDecay:
+        parameter.hints      = kParameterIsAutomatable;
+        parameter.name       = "Decay";
+        parameter.symbol     = "decay";
+        parameter.unit       = "%";
+        parameter.ranges.def = 0.0f;
+        parameter.ranges.min = 0.0f;
+        parameter.ranges.max = 100.0f;
+        break;
     }
 }
 
@@ -89,6 +107,7 @@ float DistrhoPluginKars::getParameterValue(uint32_t index) const
     case paramSustain: return fSustain ? 1.0f : 0.0f;
     case paramRelease: return fRelease;
     case paramVolume:  return fVolume;
+    case paramDecay:   return fDecay;
     }
 
     return 0.0f;
@@ -107,6 +126,9 @@ void DistrhoPluginKars::setParameterValue(uint32_t index, float value)
     case paramVolume:
         fVolume = value;
         break;
+    case paramDecay:
+        fDecay = value;
+        break;
     }
 }
 
@@ -116,12 +138,13 @@ void DistrhoPluginKars::setParameterValue(uint32_t index, float value)
 void DistrhoPluginKars::activate()
 {
     fBlockStart = 0;
+    fActiveNoteCount = 0;
 
     for (int i=kMaxNotes; --i >= 0;)
     {
-        fNotes[i].on  = kNoteNull;
         fNotes[i].off = kNoteNull;
         fNotes[i].velocity = 0;
+        fNotes[i].active = false;
     }
 }
 
@@ -148,9 +171,7 @@ void DistrhoPluginKars::run(const float**, float** outputs, uint32_t frames, con
                 DISTRHO_SAFE_ASSERT_BREAK(note < 128); // kMaxNotes
                 if (velo > 0)
                 {
-                    fNotes[note].on  = fBlockStart;
-                    fNotes[note].off = kNoteNull;
-                    fNotes[note].velocity = velo;
+                    noteOn(note, velo);
                     break;
                 }
                 // fall through
@@ -164,10 +185,19 @@ void DistrhoPluginKars::run(const float**, float** outputs, uint32_t frames, con
 
         float* const out = amsh.outputs[0];
 
-        for (int i=kMaxNotes; --i >= 0;)
+        for (uint32_t i=0; i<fActiveNoteCount;)
         {
-            if (fNotes[i].on != kNoteNull)
-                addSamples(out, i, amsh.frames);
+            const uint8_t voice = fActiveNotes[i];
+
+            if (addSamples(out, voice, amsh.frames))
+            {
+                ++i;
+                continue;
+            }
+
+            // note has finished, move the last active one into its place
+            fNotes[voice].active = false;
+            fActiveNotes[i] = fActiveNotes[--fActiveNoteCount];
         }
 
         fBlockStart += amsh.frames;
@@ -176,71 +206,136 @@ void DistrhoPluginKars::run(const float**, float** outputs, uint32_t frames, con
 
 void DistrhoPluginKars::sampleRateChanged(double newSampleRate)
 {
-    fSampleRate = getSampleRate();
+    fSampleRate = newSampleRate;
+    allocateWavetables();
+
+    fActiveNoteCount = 0;
 
     for (int i=kMaxNotes; --i >= 0;)
-        fNotes[i].setSampleRate(newSampleRate);
+        fNotes[i].active = false;
 }
 
-void DistrhoPluginKars::addSamples(float* out, int voice, uint32_t frames)
+void DistrhoPluginKars::allocateWavetables()
 {
-    const uint32_t start = fBlockStart;
+    size_t size = 0;
+
+    for (int i=0; i<kMaxNotes; ++i)
+    {
+        fNotes[i].setSampleRate(fSampleRate);
+        size += static_cast<size_t>(fNotes[i].sizei);
+    }
 
+    // only grow, switching back to a lower sample rate reuses the previous allocation
+    if (size > fWavetablesSize)
+    {
+        delete[] fWavetables;
+        fWavetables = new float[size];
+        fWavetablesSize = size;
+    }
+
+    float* wavetable = fWavetables;
+
+    for (int i=0; i<kMaxNotes; ++i)
+    {
+        fNotes[i].wavetable = wavetable;
+        wavetable += fNotes[i].sizei;
+    }
+}
+
+void DistrhoPluginKars::noteOn(const uint8_t voice, const uint8_t velocity) noexcept
+{
     Note& note(fNotes[voice]);
 
-    if (start < note.on)
-        return;
+    // 0.5 is the classic two point average, lower values damp less and ring longer
+    note.setStretch(0.5f - 0.45f * (fDecay / 100.0f));
+
+    for (int i=note.length; --i >= 0;)
+        note.wavetable[i] = getNoise();
 
-    if (start == note.on)
+    note.off = kNoteNull;
+    note.velocity = velocity;
+    note.position = 0;
+    note.last = 0.0f;
+    note.allpassIn = 0.0f;
+    note.allpassOut = 0.0f;
+
+    if (! note.active)
     {
-        for (int i=note.sizei; --i >= 0;)
-            note.wavetable[i] = (float(rand()) / float(RAND_MAX)) * 2.0f - 1.0f;
+        note.active = true;
+        fActiveNotes[fActiveNoteCount++] = voice;
     }
+}
+
+bool DistrhoPluginKars::addSamples(float* out, int voice, uint32_t frames) noexcept
+{
+    Note& note(fNotes[voice]);
 
-    const float vgain = float(note.velocity) / 127.0f;
+    const float volume = float(note.velocity) / 127.0f * (fVolume / 100.0f);
 
-    bool decay;
-    float gain, sample;
-    uint32_t index, size;
+    bool playing = true;
+    float gain = volume;
+    float gainStep = 0.0f;
 
-    for (uint32_t i=0, s=start-note.on; i<frames; ++i, ++s)
+    if ((! fSustain) && note.off != kNoteNull)
     {
-        gain = vgain;
+        // linear fade out, note-off always happens at or before the start of this block
+        const uint32_t release = 1 + uint32_t(fRelease * fSampleRate);
+        const uint32_t dist    = fBlockStart - note.off;
 
-        if ((! fSustain) && note.off != kNoteNull && note.off < i+start)
-        {
-            // reuse index and size to save some performance.
-            // actual values are release and dist
-            index = 1 + uint32_t(fRelease * fSampleRate); // release, not index
-            size  = i + start - note.off;                 // dist, not size
+        if (dist > release)
+            return false;
 
-            if (size > index)
-            {
-                note.on = kNoteNull;
-                break;
-            }
+        gain     = volume * float(release - dist) / float(release);
+        gainStep = -volume / float(release);
 
-            gain = gain * float(index - size) / float(index);
+        if (frames > release - dist)
+        {
+            frames  = release - dist + 1;
+            playing = false;
         }
+    }
 
-        size  = uint32_t(note.sizei);
-        decay = s > size;
-        index = s % size;
+    const float stretch = note.stretch;
+    const float allpass = note.allpass;
+    float last       = note.last;
+    float allpassIn  = note.allpassIn;
+    float allpassOut = note.allpassOut;
 
-        sample = note.wavetable[index];
+    float* const start = note.wavetable;
+    float* const end   = note.wavetable + note.length;
+    float* wavetable   = start + note.position;
 
-        if (decay)
-        {
-            if (index == 0)
-                sample += note.wavetable[size-1];
-            else
-                sample += note.wavetable[index-1];
+    while (frames != 0)
+    {
+        // process until the end of the delay line, so that the inner loop never wraps around
+        uint32_t count = std::min(frames, static_cast<uint32_t>(end - wavetable));
+        frames -= count;
 
-            note.wavetable[index] = sample/2;
+        for (; count != 0; --count)
+        {
+            // loop filter, then the allpass tuning the fractional part of the period
+            const float current = *wavetable;
+            const float sample  = current + stretch * (last - current);
+            last = current;
+
+            allpassOut = allpass * (sample - allpassOut) + allpassIn;
+            allpassIn  = sample;
+            *wavetable++ = allpassOut;
+
+            // twice the loop signal, the level of the previous averaging loop
+            *out++ += gain * 2.0f * sample;
+            gain += gainStep;
         }
 
-        out[i] += gain * sample * (fVolume / 100.0f);
+        if (wavetable == end)
+            wavetable = start;
     }
+
+    note.position = static_cast<int>(wavetable - start);
+    note.last = last;
+    note.allpassIn = allpassIn;
+    note.allpassOut = allpassOut;
+    return playing;
 }
 
 // -----------------------------------------------------------------------
@@ -34,10 +34,12 @@ public:
         paramSustain = 0,
         paramRelease,
         paramVolume,
+        paramDecay,
         paramCount
     };
 
     DistrhoPluginKars();
+    ~DistrhoPluginKars() override;
 
 protected:
     // -------------------------------------------------------------------
@@ -103,50 +105,88 @@ private:
     bool     fSustain;
     float    fRelease;
     float    fVolume;
+    float    fDecay;
     double   fSampleRate;
     uint32_t fBlockStart;
+    uint32_t fNoiseState;
 
     struct Note {
-        uint32_t on;
         uint32_t off;
         uint8_t  velocity;
+        bool   active;
         float  voice;
         float  size;
         int    sizei;
+        int    length;
+        int    position;
+        float  stretch;
+        float  allpass;
+        float  last;
+        float  allpassIn;
+        float  allpassOut;
         float* wavetable;
 
         Note() noexcept
-          : on(kNoteNull),
-            off(kNoteNull),
+          : off(kNoteNull),
             velocity(0),
+            active(false),
             voice(0.0f),
             size(0.0f),
+            sizei(0),
+            length(0),
+            position(0),
+            stretch(0.5f),
+            allpass(0.0f),
+            last(0.0f),
+            allpassIn(0.0f),
+            allpassOut(0.0f),
             wavetable(nullptr) {}
 
-        ~Note() noexcept
+        void setSampleRate(const double sampleRate) noexcept
         {
-            if (wavetable != nullptr)
-            {
-                delete[] wavetable;
-                wavetable = nullptr;
-            }
+            const float frequency = 440.0f * std::pow(2.0f, (voice - 69.0f) / 12.0f);
+            size  = sampleRate / frequency;
+            sizei = int(size)+1;
         }
 
-        void setSampleRate(const double sampleRate)
+        // Splits the string period into the delay line length, the phase delay of the loop filter
+        // and a first order allpass for the remaining fraction, see Jaffe & Smith (1983).
+        // Keeping the allpass delay between 0.1 and 1.1 samples avoids its poor phase response near 0.
+        void setStretch(const float newStretch) noexcept
         {
-            if (wavetable != nullptr)
-                delete[] wavetable;
+            const float omega = 2.0f * float(M_PI) / size;
+            const float filterDelay = std::atan2(newStretch * std::sin(omega),
+                                                 1.0f - newStretch + newStretch * std::cos(omega)) / omega;
 
-            const float frequency = 440.0f * std::pow(2.0f, (voice - 69.0f) / 12.0f);
-            size  = sampleRate / frequency;
-            sizei = int(size)+1;
-            wavetable = new float[sizei];
-            std::memset(wavetable, 0, sizeof(float)*static_cast<size_t>(sizei));
+            stretch = newStretch;
+            length  = std::max(1, int(size - filterDelay - 0.1f));
+
+            const float delay = size - filterDelay - float(length);
+            allpass = std::sin(omega * (1.0f - delay) / 2) / std::sin(omega * (1.0f + delay) / 2);
         }
 
     } fNotes[kMaxNotes];
 
-    void addSamples(float* out, int voice, uint32_t frames);
+    // notes currently playing, so that run() does not need to scan all of fNotes
+    uint8_t  fActiveNotes[kMaxNotes];
+    uint32_t fActiveNoteCount;
+
+    // wavetables of all notes, in a single allocation only done when the sample rate changes
+    float*   fWavetables;
+    size_t   fWavetablesSize;
+
+    void allocateWavetables();
+    void noteOn(uint8_t note, uint8_t velocity) noexcept;
+    bool addSamples(float* out, int voice, uint32_t frames) noexcept;
+
+    // xorshift32, rand() is not realtime safe and has global state
+    float getNoise() noexcept
+    {
+        fNoiseState ^= fNoiseState << 13;
+        fNoiseState ^= fNoiseState >> 17;
+        fNoiseState ^= fNoiseState << 5;
+        return float(static_cast<int32_t>(fNoiseState)) * (1.0f / 2147483648.0f);
+    }
 
     DISTRHO_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DistrhoPluginKars)
 };
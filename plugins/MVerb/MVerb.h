@@ -21,29 +21,36 @@
 #include <cstring>
 
 //forward declaration
-template<typename T, int maxLength> class Allpass;
-template<typename T, int maxLength> class StaticAllpassFourTap;
-template<typename T, int maxLength> class StaticDelayLine;
-template<typename T, int maxLength> class StaticDelayLineFourTap;
-template<typename T, int maxLength> class StaticDelayLineEightTap;
+template<typename T> class DelayLine;
+template<typename T, int TapCount> class DelayLineTaps;
+template<typename T> class Allpass;
+template<typename T> class StaticAllpassFourTap;
+template<typename T> class StaticDelayLine;
+template<typename T> class StaticDelayLineFourTap;
+template<typename T> class StaticDelayLineEightTap;
 template<typename T, int OverSampleCount> class StateVariable;
 
 template<typename T>
 class MVerb
 {
 private:
-    Allpass<T, 96000> allpass[4];
-    StaticAllpassFourTap<T, 96000> allpassFourTap[4];
+    Allpass<T> allpass[4];
+    StaticAllpassFourTap<T> allpassFourTap[4];
     StateVariable<T,4> bandwidthFilter[2];
     StateVariable<T,4> damping[2];
-    StaticDelayLine<T, 96000> predelay;
-    StaticDelayLineFourTap<T, 96000> staticDelayLine[4];
-    StaticDelayLineEightTap<T, 96000> earlyReflectionsDelayLine[2];
+    StaticDelayLine<T> predelay;
+    StaticDelayLineFourTap<T> staticDelayLine[4];
+    StaticDelayLineEightTap<T> earlyReflectionsDelayLine[2];
+    T *Arena;
+    int ArenaSize;
     T SampleRate, DampingFreq, Density1, Density2, BandwidthFreq, PreDelayTime, Decay, Gain, Mix, EarlyMix, Size;
     T MixSmooth, EarlyLateSmooth, BandwidthSmooth, DampingSmooth, PredelaySmooth, SizeSmooth, DensitySmooth, DecaySmooth;
     T PreviousLeftTank, PreviousRightTank;
     int ControlRate, ControlRateCounter;
 
+    //number of samples processed with the same smoothed parameter values
+    enum { SubBlockSize = 16 };
+
 public:
     enum
     {
@@ -74,11 +81,14 @@ public:
         MixSmooth = EarlyLateSmooth = BandwidthSmooth = DampingSmooth = PredelaySmooth = SizeSmooth = DecaySmooth = DensitySmooth = 0.;
         ControlRate = SampleRate / 1000;
         ControlRateCounter = 0;
+        Arena = 0;
+        ArenaSize = 0;
+        allocate();
         reset();
     }
 
     ~MVerb(){
-        //nowt to do here
+        delete[] Arena;
     }
 
     void process(const T **inputs, T **outputs, int sampleFrames){
@@ -91,17 +101,19 @@ public:
         T SizeDelta	= (Size - SizeSmooth) * OneOverSampleFrames;
         T DecayDelta = (((0.7995f * Decay) + 0.005) - DecaySmooth) * OneOverSampleFrames;
         T DensityDelta = (((0.7995f * Density1) + 0.005) - DensitySmooth) * OneOverSampleFrames;
-        for(int i=0;i<sampleFrames;++i){
-            T left = inputs[0][i];
-            T right = inputs[1][i];
-            MixSmooth += MixDelta;
-            EarlyLateSmooth += EarlyLateDelta;
-            BandwidthSmooth += BandwidthDelta;
-            DampingSmooth += DampingDelta;
-            PredelaySmooth += PredelayDelta;
-            SizeSmooth += SizeDelta;
-            DecaySmooth += DecayDelta;
-            DensitySmooth += DensityDelta;
+        for(int offset=0;offset<sampleFrames;offset+=SubBlockSize){
+            //control rate: the smoothed parameters only move once per sub-block,
+            //only the wet/dry mix is still ramped per sample
+            const int frames = sampleFrames - offset < SubBlockSize ? sampleFrames - offset : SubBlockSize;
+            const T mixStart = MixSmooth;
+            MixSmooth += MixDelta * frames;
+            EarlyLateSmooth += EarlyLateDelta * frames;
+            BandwidthSmooth += BandwidthDelta * frames;
+            DampingSmooth += DampingDelta * frames;
+            PredelaySmooth += PredelayDelta * frames;
+            SizeSmooth += SizeDelta * frames;
+            DecaySmooth += DecayDelta * frames;
+            DensitySmooth += DensityDelta * frames;
             if (ControlRateCounter >= ControlRate){
                 ControlRateCounter = 0;
                 bandwidthFilter[0].Frequency(BandwidthSmooth);
@@ -109,7 +121,7 @@ public:
                 damping[0].Frequency(DampingSmooth);
                 damping[1].Frequency(DampingSmooth);
             }
-            ++ControlRateCounter;
+            ControlRateCounter += frames;
             predelay.SetLength(PredelaySmooth);
             Density2 = DecaySmooth + 0.15;
             if (Density2 > 0.5)
@@ -120,60 +132,72 @@ public:
             allpassFourTap[3].SetFeedback(Density2);
             allpassFourTap[0].SetFeedback(Density1);
             allpassFourTap[2].SetFeedback(Density1);
-            T bandwidthLeft = bandwidthFilter[0](left) ;
-            T bandwidthRight = bandwidthFilter[1](right) ;
-            T earlyReflectionsL = earlyReflectionsDelayLine[0] ( bandwidthLeft * 0.5 + bandwidthRight * 0.3 )
-                    + earlyReflectionsDelayLine[0].GetIndex(2) * 0.6
-                    + earlyReflectionsDelayLine[0].GetIndex(3) * 0.4
-                    + earlyReflectionsDelayLine[0].GetIndex(4) * 0.3
-                    + earlyReflectionsDelayLine[0].GetIndex(5) * 0.3
-                    + earlyReflectionsDelayLine[0].GetIndex(6) * 0.1
-                    + earlyReflectionsDelayLine[0].GetIndex(7) * 0.1
-                    + ( bandwidthLeft * 0.4 + bandwidthRight * 0.2 ) * 0.5 ;
-            T earlyReflectionsR = earlyReflectionsDelayLine[1] ( bandwidthLeft * 0.3 + bandwidthRight * 0.5 )
-                    + earlyReflectionsDelayLine[1].GetIndex(2) * 0.6
-                    + earlyReflectionsDelayLine[1].GetIndex(3) * 0.4
-                    + earlyReflectionsDelayLine[1].GetIndex(4) * 0.3
-                    + earlyReflectionsDelayLine[1].GetIndex(5) * 0.3
-                    + earlyReflectionsDelayLine[1].GetIndex(6) * 0.1
-                    + earlyReflectionsDelayLine[1].GetIndex(7) * 0.1
-                    + ( bandwidthLeft * 0.2 + bandwidthRight * 0.4 ) * 0.5 ;
-            T predelayMonoInput = predelay(( bandwidthRight + bandwidthLeft ) * 0.5f);
-            T smearedInput = predelayMonoInput;
-            for(int j=0;j<4;j++)
-                smearedInput = allpass[j] ( smearedInput );
-            T leftTank = allpassFourTap[0] ( smearedInput + PreviousRightTank ) ;
-            leftTank = staticDelayLine[0] (leftTank);
-            leftTank = damping[0](leftTank);
-            leftTank = allpassFourTap[1](leftTank);
-            leftTank = staticDelayLine[1](leftTank);
-            T rightTank = allpassFourTap[2] (smearedInput + PreviousLeftTank) ;
-            rightTank = staticDelayLine[2](rightTank);
-            rightTank = damping[1] (rightTank);
-            rightTank = allpassFourTap[3](rightTank);
-            rightTank = staticDelayLine[3](rightTank);
-            PreviousLeftTank = leftTank * DecaySmooth;
-            PreviousRightTank = rightTank * DecaySmooth;
-            T accumulatorL = (0.6*staticDelayLine[2].GetIndex(1))
-                    +(0.6*staticDelayLine[2].GetIndex(2))
-                    -(0.6*allpassFourTap[3].GetIndex(1))
-                    +(0.6*staticDelayLine[3].GetIndex(1))
-                    -(0.6*staticDelayLine[0].GetIndex(1))
-                    -(0.6*allpassFourTap[1].GetIndex(1))
-                    -(0.6*staticDelayLine[1].GetIndex(1));
-            T accumulatorR = (0.6*staticDelayLine[0].GetIndex(2))
-                    +(0.6*staticDelayLine[0].GetIndex(3))
-                    -(0.6*allpassFourTap[1].GetIndex(2))
-                    +(0.6*staticDelayLine[1].GetIndex(2))
-                    -(0.6*staticDelayLine[2].GetIndex(3))
-                    -(0.6*allpassFourTap[3].GetIndex(2))
-                    -(0.6*staticDelayLine[3].GetIndex(2));
-            accumulatorL = ((accumulatorL * EarlyMix) + ((1 - EarlyMix) * earlyReflectionsL));
-            accumulatorR = ((accumulatorR * EarlyMix) + ((1 - EarlyMix) * earlyReflectionsR));
-            left = ( left + MixSmooth * ( accumulatorL - left ) ) * Gain;
-            right = ( right + MixSmooth * ( accumulatorR - right ) ) * Gain;
-            outputs[0][i] = left;
-            outputs[1][i] = right;
+            const T decay = DecaySmooth;
+            const T earlyMix = EarlyMix;
+            const T gain = Gain;
+            const T *inputL = inputs[0] + offset;
+            const T *inputR = inputs[1] + offset;
+            T *outputL = outputs[0] + offset;
+            T *outputR = outputs[1] + offset;
+            for(int i=0;i<frames;++i){
+                T left = inputL[i];
+                T right = inputR[i];
+                const T mix = mixStart + MixDelta * (i + 1);
+                T bandwidthLeft = bandwidthFilter[0](left) ;
+                T bandwidthRight = bandwidthFilter[1](right) ;
+                T earlyReflectionsL = earlyReflectionsDelayLine[0] ( bandwidthLeft * 0.5 + bandwidthRight * 0.3 )
+                        + earlyReflectionsDelayLine[0].GetIndex(2) * 0.6
+                        + earlyReflectionsDelayLine[0].GetIndex(3) * 0.4
+                        + earlyReflectionsDelayLine[0].GetIndex(4) * 0.3
+                        + earlyReflectionsDelayLine[0].GetIndex(5) * 0.3
+                        + earlyReflectionsDelayLine[0].GetIndex(6) * 0.1
+                        + earlyReflectionsDelayLine[0].GetIndex(7) * 0.1
+                        + ( bandwidthLeft * 0.4 + bandwidthRight * 0.2 ) * 0.5 ;
+                T earlyReflectionsR = earlyReflectionsDelayLine[1] ( bandwidthLeft * 0.3 + bandwidthRight * 0.5 )
+                        + earlyReflectionsDelayLine[1].GetIndex(2) * 0.6
+                        + earlyReflectionsDelayLine[1].GetIndex(3) * 0.4
+                        + earlyReflectionsDelayLine[1].GetIndex(4) * 0.3
+                        + earlyReflectionsDelayLine[1].GetIndex(5) * 0.3
+                        + earlyReflectionsDelayLine[1].GetIndex(6) * 0.1
+                        + earlyReflectionsDelayLine[1].GetIndex(7) * 0.1
+                        + ( bandwidthLeft * 0.2 + bandwidthRight * 0.4 ) * 0.5 ;
+                T predelayMonoInput = predelay(( bandwidthRight + bandwidthLeft ) * 0.5f);
+                T smearedInput = predelayMonoInput;
+                for(int j=0;j<4;j++)
+                    smearedInput = allpass[j] ( smearedInput );
+                T leftTank = allpassFourTap[0] ( smearedInput + PreviousRightTank ) ;
+                leftTank = staticDelayLine[0] (leftTank);
+                leftTank = damping[0](leftTank);
+                leftTank = allpassFourTap[1](leftTank);
+                leftTank = staticDelayLine[1](leftTank);
+                T rightTank = allpassFourTap[2] (smearedInput + PreviousLeftTank) ;
+                rightTank = staticDelayLine[2](rightTank);
+                rightTank = damping[1] (rightTank);
+                rightTank = allpassFourTap[3](rightTank);
+                rightTank = staticDelayLine[3](rightTank);
+                PreviousLeftTank = leftTank * decay;
+                PreviousRightTank = rightTank * decay;
+                T accumulatorL = (0.6*staticDelayLine[2].GetIndex(1))
+                        +(0.6*staticDelayLine[2].GetIndex(2))
+                        -(0.6*allpassFourTap[3].GetIndex(1))
+                        +(0.6*staticDelayLine[3].GetIndex(1))
+                        -(0.6*staticDelayLine[0].GetIndex(1))
+                        -(0.6*allpassFourTap[1].GetIndex(1))
+                        -(0.6*staticDelayLine[1].GetIndex(1));
+                T accumulatorR = (0.6*staticDelayLine[0].GetIndex(2))
+                        +(0.6*staticDelayLine[0].GetIndex(3))
+                        -(0.6*allpassFourTap[1].GetIndex(2))
+                        +(0.6*staticDelayLine[1].GetIndex(2))
+                        -(0.6*staticDelayLine[2].GetIndex(3))
+                        -(0.6*allpassFourTap[3].GetIndex(2))
+                        -(0.6*staticDelayLine[3].GetIndex(2));
+                accumulatorL = ((accumulatorL * earlyMix) + ((1 - earlyMix) * earlyReflectionsL));
+                accumulatorR = ((accumulatorR * earlyMix) + ((1 - earlyMix) * earlyReflectionsR));
+                left = ( left + mix * ( accumulatorL - left ) ) * gain;
+                right = ( right + mix * ( accumulatorR - right ) ) * gain;
+                outputL[i] = left;
+                outputR[i] = right;
+            }
         }
     }
 
@@ -329,59 +353,112 @@ public:
     void setSampleRate(T sr){
         SampleRate = sr;
         ControlRate = SampleRate / 1000;
+        allocate();
         reset();
     }
+
+private:
+    MVerb(const MVerb&);
+    MVerb& operator=(const MVerb&);
+
+    //longest delay of each line in seconds, at the maximum size and predelay
+    static int DelaySize(T seconds, T sampleRate){
+        const int length = seconds * sampleRate;
+        int size = 1;
+        while (size <= length)
+            size <<= 1;
+        return size;
+    }
+
+    //all delay lines share one buffer, only reallocated when the sample rate needs a bigger one
+    void allocate(){
+        static const T allpassTimes[4] = { 0.0048, 0.0036, 0.0127, 0.0093 };
+        static const T allpassFourTapTimes[4] = { 0.020, 0.060, 0.030, 0.089 };
+        static const T staticDelayLineTimes[4] = { 0.15, 0.12, 0.14, 0.11 };
+        static const T earlyReflectionsTimes[2] = { 0.089, 0.069 };
+        static const T predelayTime = 0.2;
+
+        int sizes[15], total = 0, n = 0;
+        for (int i = 0; i < 4; ++i)
+            total += sizes[n++] = DelaySize(allpassTimes[i], SampleRate);
+        for (int i = 0; i < 4; ++i)
+            total += sizes[n++] = DelaySize(allpassFourTapTimes[i], SampleRate);
+        for (int i = 0; i < 4; ++i)
+            total += sizes[n++] = DelaySize(staticDelayLineTimes[i], SampleRate);
+        for (int i = 0; i < 2; ++i)
+            total += sizes[n++] = DelaySize(earlyReflectionsTimes[i], SampleRate);
+        total += sizes[n++] = DelaySize(predelayTime, SampleRate);
+
+        if (total > ArenaSize){
+            delete[] Arena;
+            Arena = new T[total];
+            ArenaSize = total;
+        }
+
+        T *buffer = Arena;
+        n = 0;
+        for (int i = 0; i < 4; ++i, buffer += sizes[n++])
+            allpass[i].SetBuffer(buffer, sizes[n]);
+        for (int i = 0; i < 4; ++i, buffer += sizes[n++])
+            allpassFourTap[i].SetBuffer(buffer, sizes[n]);
+        for (int i = 0; i < 4; ++i, buffer += sizes[n++])
+            staticDelayLine[i].SetBuffer(buffer, sizes[n]);
+        for (int i = 0; i < 2; ++i, buffer += sizes[n++])
+            earlyReflectionsDelayLine[i].SetBuffer(buffer, sizes[n]);
+        predelay.SetBuffer(buffer, sizes[n]);
+    }
 };
 
 
 
-template<typename T, int maxLength>
-class Allpass
+//ring buffer with a power of two size inside the arena of MVerb,
+//so that wrapping the indexes is a mask instead of a branch
+template<typename T>
+class DelayLine
 {
-private:
-    T buffer[maxLength];
+protected:
+    T *buffer;
+    int mask;
     int index;
     int Length;
-    T Feedback;
 
-public:
-    Allpass()
+    //value written delay samples before the current write position
+    T Read(int delay) const
     {
-        SetLength ( maxLength - 1 );
-        Clear();
-        Feedback = 0.5;
+        return buffer[(index - delay) & mask];
     }
 
-    T operator()(T input)
+    void Write(T input)
     {
-        T output;
-        T bufout;
-        bufout = buffer[index];
-        T temp = input * -Feedback;
-        output = bufout + temp;
-        buffer[index] = input + ((bufout+temp)*Feedback);
-        if(++index>=Length) index = 0;
-        return output;
+        buffer[index] = input;
+        index = (index + 1) & mask;
     }
 
-    void SetLength (int Length)
-    {
-        if( Length >= maxLength )
-            Length = maxLength;
-        if( Length < 0 )
-            Length = 0;
+public:
+    DelayLine()
+        : buffer(0), mask(0), index(0), Length(0) {}
 
-        this->Length = Length;
+    void SetBuffer(T *buffer, int size)
+    {
+        this->buffer = buffer;
+        mask = size - 1;
+        Clear();
     }
 
-    void SetFeedback(T feedback)
+    void SetLength (int Length)
     {
-        Feedback = feedback;
+        //a length of 0 behaved as a delay of one sample
+        if( Length > mask + 1 )
+            Length = mask + 1;
+        if( Length < 1 )
+            Length = 1;
+
+        this->Length = Length;
     }
 
     void Clear()
     {
-        std::memset(buffer, 0, sizeof(buffer));
+        std::memset(buffer, 0, sizeof(T) * (mask + 1));
         index = 0;
     }
 
@@ -391,20 +468,15 @@ public:
     }
 };
 
-template<typename T, int maxLength>
-class StaticAllpassFourTap
+template<typename T>
+class Allpass : public DelayLine<T>
 {
 private:
-    T buffer[maxLength];
-    int index1, index2, index3, index4;
-    int Length;
     T Feedback;
 
 public:
-    StaticAllpassFourTap()
+    Allpass()
     {
-        SetLength ( maxLength - 1 );
-        Clear();
         Feedback = 0.5;
     }
 
@@ -412,326 +484,134 @@ public:
     {
         T output;
         T bufout;
-
-        bufout = buffer[index1];
+        bufout = this->Read(this->Length);
         T temp = input * -Feedback;
         output = bufout + temp;
-        buffer[index1] = input + ((bufout+temp)*Feedback);
-
-        if(++index1>=Length)
-            index1 = 0;
-        if(++index2 >= Length)
-            index2 = 0;
-        if(++index3 >= Length)
-            index3 = 0;
-        if(++index4 >= Length)
-            index4 = 0;
-
+        this->Write(input + ((bufout+temp)*Feedback));
         return output;
     }
 
-    void SetIndex (int Index1, int Index2, int Index3, int Index4)
-    {
-        index1 = Index1;
-        index2 = Index2;
-        index3 = Index3;
-        index4 = Index4;
-    }
-
-    T GetIndex (int Index)
-    {
-        switch (Index)
-        {
-        case 0:
-            return buffer[index1];
-            break;
-        case 1:
-            return buffer[index2];
-            break;
-        case 2:
-            return buffer[index3];
-            break;
-        case 3:
-            return buffer[index4];
-            break;
-        default:
-            return buffer[index1];
-            break;
-        }
-    }
-
-    void SetLength (int Length)
+    void SetFeedback(T feedback)
     {
-        if( Length >= maxLength )
-            Length = maxLength;
-        if( Length < 0 )
-            Length = 0;
-
-        this->Length = Length;
+        Feedback = feedback;
     }
+};
 
+//taps are given as offsets from the oldest sample, like the indexes they replaced
+template<typename T, int TapCount>
+class DelayLineTaps : public DelayLine<T>
+{
+protected:
+    int taps[TapCount];
 
-    void Clear()
+public:
+    DelayLineTaps()
     {
-        std::memset(buffer, 0, sizeof(buffer));
-        index1 = index2  = index3 = index4 = 0;
+        std::memset(taps, 0, sizeof(taps));
     }
 
-    void SetFeedback(T feedback)
+    T GetIndex (int Index)
     {
-        Feedback = feedback;
-    }
-
-    int GetLength() const
-    {
-        return Length;
+        if (Index < 0 || Index >= TapCount)
+            Index = 0;
+        return this->Read(this->Length - taps[Index]);
     }
 };
 
-template<typename T, int maxLength>
-class StaticDelayLine
+template<typename T>
+class StaticAllpassFourTap : public DelayLineTaps<T, 4>
 {
 private:
-    T buffer[maxLength];
-    int index;
-    int Length;
     T Feedback;
 
 public:
-    StaticDelayLine()
+    StaticAllpassFourTap()
     {
-        SetLength ( maxLength - 1 );
-        Clear();
+        Feedback = 0.5;
     }
 
     T operator()(T input)
     {
-        T output = buffer[index];
-        buffer[index++] = input;
-        if(index >= Length)
-            index = 0;
-        return output;
-    }
+        T output;
+        T bufout;
 
-    void SetLength (int Length)
-    {
-        if( Length >= maxLength )
-            Length = maxLength;
-        if( Length < 0 )
-            Length = 0;
+        bufout = this->Read(this->Length);
+        T temp = input * -Feedback;
+        output = bufout + temp;
+        this->Write(input + ((bufout+temp)*Feedback));
 
-        this->Length = Length;
+        return output;
     }
 
-    void Clear()
+    void SetIndex (int Index1, int Index2, int Index3, int Index4)
     {
-        std::memset(buffer, 0, sizeof(buffer));
-        index = 0;
+        this->taps[0] = Index1;
+        this->taps[1] = Index2;
+        this->taps[2] = Index3;
+        this->taps[3] = Index4;
     }
 
-    int GetLength() const
+    void SetFeedback(T feedback)
     {
-        return Length;
+        Feedback = feedback;
     }
 };
 
-template<typename T, int maxLength>
-class StaticDelayLineFourTap
+template<typename T>
+class StaticDelayLine : public DelayLine<T>
 {
-private:
-    T buffer[maxLength];
-    int index1, index2, index3, index4;
-    int Length;
-    T Feedback;
-
 public:
-    StaticDelayLineFourTap()
+    T operator()(T input)
     {
-        SetLength ( maxLength - 1 );
-        Clear();
+        T output = this->Read(this->Length);
+        this->Write(input);
+        return output;
     }
+};
 
+template<typename T>
+class StaticDelayLineFourTap : public DelayLineTaps<T, 4>
+{
+public:
     //get ouput and iterate
     T operator()(T input)
     {
-        T output = buffer[index1];
-        buffer[index1++] = input;
-        if(index1 >= Length)
-            index1 = 0;
-        if(++index2 >= Length)
-            index2 = 0;
-        if(++index3 >= Length)
-            index3 = 0;
-        if(++index4 >= Length)
-            index4 = 0;
+        T output = this->Read(this->Length);
+        this->Write(input);
         return output;
     }
 
     void SetIndex (int Index1, int Index2, int Index3, int Index4)
     {
-        index1 = Index1;
-        index2 = Index2;
-        index3 = Index3;
-        index4 = Index4;
-    }
-
-
-    T GetIndex (int Index)
-    {
-        switch (Index)
-        {
-        case 0:
-            return buffer[index1];
-            break;
-        case 1:
-            return buffer[index2];
-            break;
-        case 2:
-            return buffer[index3];
-            break;
-        case 3:
-            return buffer[index4];
-            break;
-        default:
-            return buffer[index1];
-            break;
-        }
-    }
-
-
-    void SetLength (int Length)
-    {
-        if( Length >= maxLength )
-            Length = maxLength;
-        if( Length < 0 )
-            Length = 0;
-
-        this->Length = Length;
-    }
-
-
-    void Clear()
-    {
-        std::memset(buffer, 0, sizeof(buffer));
-        index1 = index2  = index3 = index4 = 0;
-    }
-
-
-    int GetLength() const
-    {
-        return Length;
+        this->taps[0] = Index1;
+        this->taps[1] = Index2;
+        this->taps[2] = Index3;
+        this->taps[3] = Index4;
     }
 };
 
-template<typename T, int maxLength>
-class StaticDelayLineEightTap
+template<typename T>
+class StaticDelayLineEightTap : public DelayLineTaps<T, 8>
 {
-private:
-    T buffer[maxLength];
-    int index1, index2, index3, index4, index5, index6, index7, index8;
-    int Length;
-    T Feedback;
-
 public:
-    StaticDelayLineEightTap()
-    {
-        SetLength ( maxLength - 1 );
-        Clear();
-    }
-
     //get ouput and iterate
     T operator()(T input)
     {
-        T output = buffer[index1];
-        buffer[index1++] = input;
-        if(index1 >= Length)
-            index1 = 0;
-        if(++index2 >= Length)
-            index2 = 0;
-        if(++index3 >= Length)
-            index3 = 0;
-        if(++index4 >= Length)
-            index4 = 0;
-        if(++index5 >= Length)
-            index5 = 0;
-        if(++index6 >= Length)
-            index6 = 0;
-        if(++index7 >= Length)
-            index7 = 0;
-        if(++index8 >= Length)
-            index8 = 0;
+        T output = this->Read(this->Length);
+        this->Write(input);
         return output;
-
     }
 
     void SetIndex (int Index1, int Index2, int Index3, int Index4, int Index5, int Index6, int Index7, int Index8)
     {
-        index1 = Index1;
-        index2 = Index2;
-        index3 = Index3;
-        index4 = Index4;
-        index5 = Index5;
-        index6 = Index6;
-        index7 = Index7;
-        index8 = Index8;
-    }
-
-
-    T GetIndex (int Index)
-    {
-        switch (Index)
-        {
-        case 0:
-            return buffer[index1];
-            break;
-        case 1:
-            return buffer[index2];
-            break;
-        case 2:
-            return buffer[index3];
-            break;
-        case 3:
-            return buffer[index4];
-            break;
-        case 4:
-            return buffer[index5];
-            break;
-        case 5:
-            return buffer[index6];
-            break;
-        case 6:
-            return buffer[index7];
-            break;
-        case 7:
-            return buffer[index8];
-            break;
-        default:
-            return buffer[index1];
-            break;
-        }
-    }
-
-    void SetLength (int Length)
-    {
-        if( Length >= maxLength )
-            Length = maxLength;
-        if( Length < 0 )
-            Length = 0;
-
-        this->Length = Length;
-    }
-
-
-    void Clear()
-    {
-        std::memset(buffer, 0, sizeof(buffer));
-        index1 = index2  = index3 = index4 = index5 = index6 = index7 = index8 = 0;
-    }
-
-
-    int GetLength() const
-    {
-        return Length;
+        this->taps[0] = Index1;
+        this->taps[1] = Index2;
+        this->taps[2] = Index3;
+        this->taps[3] = Index4;
+        this->taps[4] = Index5;
+        this->taps[5] = Index6;
+        this->taps[6] = Index7;
+        this->taps[7] = Index8;
     }
 };
 
@@ -761,10 +641,16 @@ private:
     T band;
     T notch;
 
+    //the input is held for all oversampled steps, so all but the last one are a linear
+    //map of the low and band state, precomputed here whenever the coefficients change
+    T a11, a12, a21, a22;
+    T b1, b2, c1, c2;
+
     T *out;
 
 public:
     StateVariable()
+        : frequency(1000.), q(2.)
     {
         SetSampleRate(44100.);
         Frequency(1000.);
@@ -775,13 +661,17 @@ public:
 
     T operator()(T input)
     {
-        for(unsigned int i = 0; i < OverSampleCount; i++)
+        if (OverSampleCount > 1)
         {
-            low += f * band + 1e-25;
-            high = input - low - q * band;
-            band += f * high;
-            notch = low + high;
+            const T newLow = a11 * low + a12 * band + b1 * input + c1;
+            band = a21 * low + a22 * band + b2 * input + c2;
+            low = newLow;
         }
+
+        low += f * band + 1e-25;
+        high = input - low - q * band;
+        band += f * high;
+        notch = low + high;
         return *out;
     }
 
@@ -805,6 +695,7 @@ public:
     void Resonance(T resonance)
     {
         this->q = 2 - 2 * resonance;
+        UpdateCoefficient();
     }
 
     void Type(int type)
@@ -837,6 +728,24 @@ private:
     void UpdateCoefficient()
     {
         f = 2. * std::sin(M_PI * frequency / sampleRate);
+
+        //one step is [low band] = A [low band] + [0 f] input + [1e-25 -f*1e-25],
+        //the first OverSampleCount-1 steps are A^(n) and the sum of A^k applied to the rest
+        const T s11 = 1, s12 = f, s21 = -f, s22 = 1 - f * f - f * q;
+        T p11 = 1, p12 = 0, p21 = 0, p22 = 1;
+        T g11 = 0, g12 = 0, g21 = 0, g22 = 0;
+        for(unsigned int i = 1; i < OverSampleCount; i++)
+        {
+            g11 += p11; g12 += p12; g21 += p21; g22 += p22;
+            const T n11 = s11 * p11 + s12 * p21, n12 = s11 * p12 + s12 * p22;
+            const T n21 = s21 * p11 + s22 * p21, n22 = s21 * p12 + s22 * p22;
+            p11 = n11; p12 = n12; p21 = n21; p22 = n22;
+        }
+        a11 = p11; a12 = p12; a21 = p21; a22 = p22;
+        b1 = g12 * f;
+        b2 = g22 * f;
+        c1 = (g11 - g12 * f) * 1e-25;
+        c2 = (g21 - g22 * f) * 1e-25;
     }
 };
 #endif
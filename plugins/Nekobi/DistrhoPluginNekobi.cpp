@@ -25,33 +25,6 @@ extern "C" {
 #include "nekobee-src/nekobee_voice_render.c"
 #include "nekobee-src/minblep_tables.c"
 
-// -----------------------------------------------------------------------
-// mutual exclusion
-
-bool dssp_voicelist_mutex_trylock(nekobee_synth_t* const synth)
-{
-    /* Attempt the mutex lock */
-    if (pthread_mutex_trylock(&synth->voicelist_mutex) != 0)
-    {
-        synth->voicelist_mutex_grab_failed = 1;
-        return false;
-    }
-
-    /* Clean up if a previous mutex grab failed */
-    if (synth->voicelist_mutex_grab_failed)
-    {
-        nekobee_synth_all_voices_off(synth);
-        synth->voicelist_mutex_grab_failed = 0;
-    }
-
-    return true;
-}
-
-bool dssp_voicelist_mutex_unlock(nekobee_synth_t* const synth)
-{
-    return (pthread_mutex_unlock(&synth->voicelist_mutex) == 0);
-}
-
 // -----------------------------------------------------------------------
 // nekobee_handle_raw_event
 
@@ -101,15 +74,20 @@ DistrhoPluginNekobi::DistrhoPluginNekobi()
     fSynth.monophonic = XSYNTH_MONO_MODE_ONCE;
     fSynth.glide = 0;
     fSynth.last_noteon_pitch = 0.0f;
-    fSynth.vcf_accent = 0.0f;
-    fSynth.vca_accent = 0.0f;
 
     for (int i=0; i<8; ++i)
         fSynth.held_keys[i] = -1;
 
-    fSynth.voice = nekobee_voice_new();
-    fSynth.voicelist_mutex_grab_failed = 0;
-    pthread_mutex_init(&fSynth.voicelist_mutex, nullptr);
+    // all voices come from a single allocation, the polyphony parameter only changes how many are used
+    nekobee_voice_t* const voices = (nekobee_voice_t*)std::calloc(XSYNTH_MAX_POLYPHONY, sizeof(nekobee_voice_t));
+
+    for (int i=0; i<XSYNTH_MAX_POLYPHONY; ++i)
+    {
+        fSynth.voice[i] = voices != nullptr ? &voices[i] : nullptr;
+
+        if (voices != nullptr)
+            voices[i].status = XSYNTH_VOICE_OFF;
+    }
 
     fSynth.channel_pressure = 0;
     fSynth.pitch_wheel_sensitivity = 0;
@@ -135,6 +113,7 @@ DistrhoPluginNekobi::DistrhoPluginNekobi()
     fParams.decay  = 75.0f;
     fParams.accent = 25.0f;
     fParams.volume = 75.0f;
+    fParams.polyphony = 1.0f;
 
     // Internal stuff
     fSynth.waveform  = 0.0f;
@@ -152,7 +131,7 @@ DistrhoPluginNekobi::DistrhoPluginNekobi()
 
 DistrhoPluginNekobi::~DistrhoPluginNekobi()
 {
-    std::free(fSynth.voice);
+    std::free(fSynth.voice[0]);
 }
 
 // -----------------------------------------------------------------------
@@ -257,6 +236,14 @@ void DistrhoPluginNekobi::initParameter(uint32_t index, Parameter& parameter)
         parameter.ranges.max = 100.0f;
         parameter.midiCC = 7; //Volume
         break;
+    case paramPolyphony:
+        parameter.hints      = kParameterIsAutomatable|kParameterIsInteger;
+        parameter.name       = "Polyphony";
+        parameter.symbol     = "polyphony";
+        parameter.ranges.def = 1.0f;
+        parameter.ranges.min = 1.0f;
+        parameter.ranges.max = XSYNTH_MAX_POLYPHONY;
+        break;
     }
 }
 
@@ -283,6 +270,8 @@ float DistrhoPluginNekobi::getParameterValue(uint32_t index) const
         return fParams.accent;
     case paramVolume:
         return fParams.volume;
+    case paramPolyphony:
+        return fParams.polyphony;
     }
 
     return 0.0f;
@@ -332,6 +321,12 @@ void DistrhoPluginNekobi::setParameterValue(uint32_t index, float value)
         fSynth.volume = value/100.0f;
         DISTRHO_SAFE_ASSERT(fSynth.volume >= 0.0f && fSynth.volume <= 1.0f);
         break;
+    case paramPolyphony:
+        fParams.polyphony = value;
+        // applied at the start of the next run(), voices are only touched there
+        fSynth.polyphony = static_cast<int>(value + 0.5f);
+        DISTRHO_SAFE_ASSERT(fSynth.polyphony >= 1 && fSynth.polyphony <= XSYNTH_MAX_POLYPHONY);
+        break;
     }
 }
 
@@ -343,13 +338,13 @@ void DistrhoPluginNekobi::activate()
     fSynth.nugget_remains = 0;
     fSynth.note_id = 0;
 
-    if (fSynth.voice != nullptr)
+    if (fSynth.voice[0] != nullptr)
         nekobee_synth_all_voices_off(&fSynth);
 }
 
 void DistrhoPluginNekobi::deactivate()
 {
-    if (fSynth.voice != nullptr)
+    if (fSynth.voice[0] != nullptr)
         nekobee_synth_all_voices_off(&fSynth);
 }
 
@@ -361,12 +356,14 @@ void DistrhoPluginNekobi::run(const float**, float** outputs, uint32_t frames, c
 
     float* out = outputs[0];
 
-    if (fSynth.voice == nullptr || ! dssp_voicelist_mutex_trylock(&fSynth))
+    if (fSynth.voice[0] == nullptr)
     {
         std::memset(out, 0, sizeof(float)*frames);
         return;
     }
 
+    nekobee_synth_set_polyphony(&fSynth, fSynth.polyphony);
+
     while (framesDone < frames)
     {
         if (fSynth.nugget_remains == 0)
@@ -375,10 +372,9 @@ void DistrhoPluginNekobi::run(const float**, float** outputs, uint32_t frames, c
         /* process any ready events */
         while (curEventIndex < midiEventCount && framesDone == midiEvents[curEventIndex].frame)
         {
-            if (midiEvents[curEventIndex].size > MidiEvent::kDataSize)
-                continue;
+            if (midiEvents[curEventIndex].size <= MidiEvent::kDataSize)
+                nekobee_handle_raw_event(&fSynth, midiEvents[curEventIndex].size, midiEvents[curEventIndex].data);
 
-            nekobee_handle_raw_event(&fSynth, midiEvents[curEventIndex].size, midiEvents[curEventIndex].data);
             curEventIndex++;
         }
 
@@ -408,8 +404,6 @@ void DistrhoPluginNekobi::run(const float**, float** outputs, uint32_t frames, c
         framesDone += burstSize;
         fSynth.nugget_remains -= burstSize;
     }
-
-    dssp_voicelist_mutex_unlock(&fSynth);
 }
 
 // -----------------------------------------------------------------------
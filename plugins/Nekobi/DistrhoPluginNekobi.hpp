@@ -42,6 +42,7 @@ public:
         paramDecay,
         paramAccent,
         paramVolume,
+        paramPolyphony,
         paramCount
     };
 
@@ -118,6 +119,7 @@ private:
         float decay;
         float accent;
         float volume;
+        float polyphony;
     } fParams;
 
     nekobee_synth_t fSynth;
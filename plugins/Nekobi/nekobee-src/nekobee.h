@@ -71,7 +71,7 @@
 
 /* ==== end of debugging ==== */
 
-#define XSYNTH_MAX_POLYPHONY     1
+#define XSYNTH_MAX_POLYPHONY     8
 #define XSYNTH_DEFAULT_POLYPHONY  1
 
 #endif /* _XSYNTH_H */
@@ -29,7 +29,6 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
-#include <pthread.h>
 
 #include "nekobee.h"
 #include "nekobee_synth.h"
@@ -46,9 +45,8 @@ nekobee_synth_all_voices_off(nekobee_synth_t *synth)
     int i;
     nekobee_voice_t *voice;
 
-    for (i = 0; i < synth->voices; i++) {
-        //voice = synth->voice[i];
-        voice = synth->voice;
+    for (i = 0; i < XSYNTH_MAX_POLYPHONY; i++) {
+        voice = synth->voice[i];
         if (_PLAYING(voice)) {
             nekobee_voice_off(voice);
         }
@@ -56,6 +54,43 @@ nekobee_synth_all_voices_off(nekobee_synth_t *synth)
     for (i = 0; i < 8; i++) synth->held_keys[i] = -1;
 }
 
+/*
+ * nekobee_synth_set_polyphony
+ *
+ * switch between the classic monophonic voice and a pool of up to
+ * XSYNTH_MAX_POLYPHONY voices, voices above the new count are stopped
+ */
+void
+nekobee_synth_set_polyphony(nekobee_synth_t *synth, int polyphony)
+{
+    int i;
+
+    if (polyphony < 1)
+        polyphony = 1;
+    else if (polyphony > XSYNTH_MAX_POLYPHONY)
+        polyphony = XSYNTH_MAX_POLYPHONY;
+
+    if (polyphony == synth->voices)
+        return;
+
+    for (i = polyphony; i < XSYNTH_MAX_POLYPHONY; i++) {
+        if (_PLAYING(synth->voice[i]))
+            nekobee_voice_off(synth->voice[i]);
+    }
+
+    /* held keys only make sense for the monophonic voice */
+    if ((polyphony == 1) != (synth->voices == 1)) {
+        for (i = 0; i < XSYNTH_MAX_POLYPHONY; i++) {
+            if (_ON(synth->voice[i]) || _SUSTAINED(synth->voice[i]))
+                nekobee_voice_release_note(synth, synth->voice[i]);
+        }
+        for (i = 0; i < 8; i++) synth->held_keys[i] = -1;
+    }
+
+    synth->voices = polyphony;
+    synth->monophonic = (polyphony == 1) ? XSYNTH_MONO_MODE_ONCE : XSYNTH_MONO_MODE_OFF;
+}
+
 /*
  * nekobee_synth_note_off
  *
@@ -67,17 +102,32 @@ nekobee_synth_note_off(nekobee_synth_t *synth, unsigned char key, unsigned char
     int i, count = 0;
     nekobee_voice_t *voice;
 
-    for (i = 0; i < synth->voices; i++) {
-        voice = synth->voice;
+    if (synth->monophonic) {
+        voice = synth->voice[0];
         if (_PLAYING(voice)) {
-            XDB_MESSAGE(XDB_NOTE, " nekobee_synth_note_off: key %d rvel %d voice %d note id %d\n", key, rvelocity, i, voice->note_id);
+            XDB_MESSAGE(XDB_NOTE, " nekobee_synth_note_off: key %d rvel %d note id %d\n", key, rvelocity, voice->note_id);
             nekobee_voice_note_off(synth, voice, key, 64);
             count++;
         }
+
+        if (!count)
+            nekobee_voice_remove_held_key(synth, key);
+
+        return;
+    }
+
+    for (i = 0; i < synth->voices; i++) {
+        voice = synth->voice[i];
+        if (voice->key == key && _ON(voice)) {
+            XDB_MESSAGE(XDB_NOTE, " nekobee_synth_note_off: key %d rvel %d voice %d note id %d\n", key, rvelocity, i, voice->note_id);
+            if (XSYNTH_SYNTH_SUSTAINED(synth))
+                voice->status = XSYNTH_VOICE_SUSTAINED;
+            else
+                nekobee_voice_release_note(synth, voice);
+        }
     }
 
-    if (!count)
-        nekobee_voice_remove_held_key(synth, key);
+    nekobee_voice_remove_held_key(synth, key);
 
     return;
     (void)rvelocity;
@@ -97,14 +147,65 @@ nekobee_synth_all_notes_off(nekobee_synth_t* synth)
     /* reset the sustain controller */
     synth->cc[MIDI_CTL_SUSTAIN] = 0;
     for (i = 0; i < synth->voices; i++) {
-        //voice = synth->voice[i];
-        voice = synth->voice;
+        voice = synth->voice[i];
         if (_ON(voice) || _SUSTAINED(voice)) {
             nekobee_voice_release_note(synth, voice);
         }
     }
 }
 
+/*
+ * nekobee_synth_damp_voices
+ *
+ * release the notes that were only held by the sustain pedal
+ */
+static void
+nekobee_synth_damp_voices(nekobee_synth_t* synth)
+{
+    int i;
+    nekobee_voice_t *voice;
+
+    for (i = 0; i < synth->voices; i++) {
+        voice = synth->voice[i];
+        if (_SUSTAINED(voice)) {
+            nekobee_voice_release_note(synth, voice);
+        }
+    }
+}
+
+/*
+ * nekobee_synth_alloc_voice
+ *
+ * pick a voice for a new note: the one already playing this key, a free one,
+ * or else steal the oldest released voice, or the oldest voice of all
+ */
+static nekobee_voice_t *
+nekobee_synth_alloc_voice(nekobee_synth_t* synth, unsigned char key)
+{
+    int i;
+    nekobee_voice_t *voice, *oldest = NULL, *oldest_released = NULL;
+
+    for (i = 0; i < synth->voices; i++) {
+        voice = synth->voice[i];
+        if (_PLAYING(voice) && voice->key == key)
+            return voice;
+    }
+
+    for (i = 0; i < synth->voices; i++) {
+        voice = synth->voice[i];
+        if (_AVAILABLE(voice))
+            return voice;
+        /* note ids wrap around, so compare their distance to the newest one */
+        if (_RELEASED(voice) && (oldest_released == NULL ||
+            synth->note_id - voice->note_id > synth->note_id - oldest_released->note_id))
+            oldest_released = voice;
+        if (oldest == NULL || synth->note_id - voice->note_id > synth->note_id - oldest->note_id)
+            oldest = voice;
+    }
+
+    return oldest_released != NULL ? oldest_released : oldest;
+}
+
 /*
  * nekobee_synth_note_on
  */
@@ -113,9 +214,13 @@ nekobee_synth_note_on(nekobee_synth_t *synth, unsigned char key, unsigned char v
 {
     nekobee_voice_t* voice;
 
-    voice = synth->voice;
-    if (_PLAYING(synth->voice)) {
-        XDB_MESSAGE(XDB_NOTE, " nekobee_synth_note_on: retriggering mono voice on new key %d\n", key);
+    if (synth->monophonic) {
+        voice = synth->voice[0];
+        if (_PLAYING(voice)) {
+            XDB_MESSAGE(XDB_NOTE, " nekobee_synth_note_on: retriggering mono voice on new key %d\n", key);
+        }
+    } else {
+        voice = nekobee_synth_alloc_voice(synth, key);
     }
 
     voice->note_id = synth->note_id++;
@@ -151,6 +256,11 @@ nekobee_synth_control_change(nekobee_synth_t *synth, unsigned int param, signed
         nekobee_synth_update_volume(synth);
         break;
 
+      case MIDI_CTL_SUSTAIN:
+        if (!XSYNTH_SYNTH_SUSTAINED(synth))
+            nekobee_synth_damp_voices(synth);
+        break;
+
       case MIDI_CTL_ALL_SOUNDS_OFF:
         nekobee_synth_all_voices_off(synth);
         break;
@@ -196,13 +306,17 @@ nekobee_synth_init_controls(nekobee_synth_t *synth)
 
 /*
  * nekobee_synth_render_voices
+ *
+ * all voices are mixed into out, nothing else accesses the voices while rendering
  */
 void
 nekobee_synth_render_voices(nekobee_synth_t *synth, float *out, unsigned long sample_count,
                         int do_control_update)
 {
     unsigned long i;
+    int v;
     float res, wow;
+    nekobee_voice_t *voice;
 
     /* clear the buffer */
     for (i = 0; i < sample_count; i++)
@@ -216,22 +330,29 @@ nekobee_synth_render_voices(nekobee_synth_t *synth, float *out, unsigned long sa
     wow = res*res;
     wow = wow/10.0f;
 
-    // as the resonance is increased, "wow" slows down the accent attack
-    if ((synth->voice->velocity>90) && (synth->vcf_accent < synth->voice->vcf_eg)) {
-        synth->vcf_accent=(0.985-wow)*synth->vcf_accent+(0.015+wow)*synth->voice->vcf_eg;
-    } else {
-        synth->vcf_accent=(0.985-wow)*synth->vcf_accent;	// or just decay
-    }
+    for (v = 0; v < synth->voices; v++) {
+        voice = synth->voice[v];
 
-    if (synth->voice->velocity>90) {
-        synth->vca_accent=0.95*synth->vca_accent+0.05; // ramp up accent on with a time constant
-    } else {
-        synth->vca_accent=0.95*synth->vca_accent;       // accent off with time constant
+        // as the resonance is increased, "wow" slows down the accent attack
+        if ((voice->velocity>90) && (voice->vcf_accent < voice->vcf_eg)) {
+            voice->vcf_accent=(0.985-wow)*voice->vcf_accent+(0.015+wow)*voice->vcf_eg;
+        } else {
+            voice->vcf_accent=(0.985-wow)*voice->vcf_accent;	// or just decay
+        }
+
+        if (voice->velocity>90) {
+            voice->vca_accent=0.95*voice->vca_accent+0.05; // ramp up accent on with a time constant
+        } else {
+            voice->vca_accent=0.95*voice->vca_accent;       // accent off with time constant
+        }
     }
 #if defined(XSYNTH_DEBUG) && (XSYNTH_DEBUG & XDB_AUDIO)
      out[0] += 0.10f; /* add a 'buzz' to output so there's something audible even when quiescent */
 #endif /* defined(XSYNTH_DEBUG) && (XSYNTH_DEBUG & XDB_AUDIO) */
-    if (_PLAYING(synth->voice)) {
-        nekobee_voice_render(synth, synth->voice, out, sample_count, do_control_update);
+    for (v = 0; v < synth->voices; v++) {
+        voice = synth->voice[v];
+        if (_PLAYING(voice)) {
+            nekobee_voice_render(synth, voice, out, sample_count, do_control_update);
+        }
     }
 }
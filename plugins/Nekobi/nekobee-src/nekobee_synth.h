@@ -26,8 +26,6 @@
 #ifndef _XSYNTH_SYNTH_H
 #define _XSYNTH_SYNTH_H
 
-#include <pthread.h>
-
 #include "nekobee.h"
 #include "nekobee_types.h"
 
@@ -59,13 +57,9 @@ struct _nekobee_synth_t {
     int             glide;             /* current glide mode */
     float           last_noteon_pitch; /* glide start pitch for non-legato modes */
     signed char     held_keys[8];      /* for monophonic key tracking, an array of note-ons, most recently received first */
-    float           vcf_accent;        /* used to emulate the circuit that sweeps the vcf at full resonance */
-    float           vca_accent;        /* used to smooth the accent pulse, removing the click */
 
-    //nekobee_voice_t *voice[XSYNTH_MAX_POLYPHONY];
-    nekobee_voice_t *voice;
-    pthread_mutex_t voicelist_mutex;
-    int             voicelist_mutex_grab_failed;
+    /* voices are only touched from the audio thread, so no locking is needed */
+    nekobee_voice_t *voice[XSYNTH_MAX_POLYPHONY];
 
     /* current non-paramter-mapped controller values */
     unsigned char   key_pressure[128];
@@ -91,6 +85,7 @@ struct _nekobee_synth_t {
 };
 
 void nekobee_synth_all_voices_off(nekobee_synth_t *synth);
+void nekobee_synth_set_polyphony(nekobee_synth_t *synth, int polyphony);
 void nekobee_synth_note_off(nekobee_synth_t *synth, unsigned char key,
                             unsigned char rvelocity);
 void nekobee_synth_all_notes_off(nekobee_synth_t *synth);
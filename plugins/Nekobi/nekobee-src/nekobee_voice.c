@@ -70,7 +70,8 @@ nekobee_voice_note_on(nekobee_synth_t *synth, nekobee_voice_t *voice,
         voice->target_pitch = nekobee_pitch[key];
         
 
-            if (synth->held_keys[0] >= 0) {
+            /* only the monophonic voice glides from the previous key */
+            if (synth->monophonic && synth->held_keys[0] >= 0) {
                 voice->prev_pitch = nekobee_pitch[synth->held_keys[0]];
             } else {
                 voice->prev_pitch = voice->target_pitch;
@@ -94,6 +94,10 @@ struct _nekobee_voice_t
     /* translated controller values */
     float         pressure;    /* filter resonance multiplier, off = 1.0, full on = 0.0 */
 
+    /* accent state, per voice so that layered notes do not share it */
+    float         vcf_accent;  /* used to emulate the circuit that sweeps the vcf at full resonance */
+    float         vca_accent;  /* used to smooth the accent pulse, removing the click */
+
     /* persistent voice state */
     float         prev_pitch,
                   target_pitch,
@@ -113,6 +117,7 @@ struct _nekobee_voice_t
     float         osc_audio[MINBLEP_BUFFER_LENGTH];
     float         freqcut_buf[XSYNTH_NUGGET_SIZE];
     float         vca_buf[XSYNTH_NUGGET_SIZE];
+    float         drive_buf[XSYNTH_NUGGET_SIZE];
 };
 
 #define _PLAYING(voice)    ((voice)->status != XSYNTH_VOICE_OFF)
@@ -220,6 +220,29 @@ void vco(unsigned long sample_count, nekobee_voice_t *voice, struct blosc *osc,
         osc->pos=pos;
 }
 
+/*
+ * fast_atanf
+ *
+ * odd polynomial fit of atan() on [0, 1], using atan(x) = pi/2 - atan(1/x)
+ * for larger values. absolute error is below 1.2e-5 over the whole real line.
+ * written without branches so that the loop calling it can be vectorized.
+ */
+static inline float
+fast_atanf(float x)
+{
+    const float ax = fabsf(x);
+    const int   inverse = ax > 1.0f;
+    const float t = inverse ? 1.0f / ax : ax;
+    const float t2 = t * t;
+    float r;
+
+    r = t * (0.99986633f + t2 * (-0.330304787f + t2 * (0.180159295f +
+             t2 * (-0.0851563485f + t2 * 0.0208451123f))));
+    r = inverse ? (float)M_PI_2 - r : r;
+
+    return copysignf(r, x);
+}
+
 static inline void
 vcf_4pole(nekobee_voice_t *voice, unsigned long sample_count,
           float *in, float *out, float *cutoff, float qres, float *amp)
@@ -230,9 +253,12 @@ vcf_4pole(nekobee_voice_t *voice, unsigned long sample_count,
           delay2 = voice->delay2,
           delay3 = voice->delay3,
           delay4 = voice->delay4;
+    float *drive = voice->drive_buf;
 
     qres = 2.0f - qres * 1.995f;
 
+    /* the filter is a recursion and has to run sample by sample,
+     * the output saturation is done afterwards for the whole nugget */
     for (sample = 0; sample < sample_count; sample++) {
 
         /* Hal Chamberlin's state variable filter */
@@ -252,10 +278,13 @@ vcf_4pole(nekobee_voice_t *voice, unsigned long sample_count,
         highpass = delay2 - delay4 - qres * delay3;
         delay3 = freqcut2 * highpass + delay3;
 
-        /* mix filter output into output buffer */
-        out[sample] += 0.1*atan(3*delay4 * amp[sample]);
+        drive[sample] = delay4;
     }
 
+    /* mix filter output into output buffer */
+    for (sample = 0; sample < sample_count; sample++)
+        out[sample] += 0.1f * fast_atanf(3.0f * drive[sample] * amp[sample]);
+
     voice->delay1 = delay1;
     voice->delay2 = delay2;
     voice->delay3 = delay3;
@@ -360,9 +389,9 @@ nekobee_voice_render(nekobee_synth_t *synth, nekobee_voice_t *voice,
         vca_eg = vca_eg_rate_level[vca_eg_phase] + vca_eg_one_rate[vca_eg_phase] * vca_eg;
         vcf_eg = vcf_eg_rate_level[vcf_eg_phase] + vcf_eg_one_rate[vcf_eg_phase] * vcf_eg;
 
-        voice->freqcut_buf[sample] = (cutoff + (vcf_amt * vcf_eg/2.0f)  + (synth->vcf_accent * synth->accent*0.5f));
+        voice->freqcut_buf[sample] = (cutoff + (vcf_amt * vcf_eg/2.0f)  + (voice->vcf_accent * synth->accent*0.5f));
 
-        voice->vca_buf[sample] = vca_eg * vol_out*(1.0f + synth->accent*synth->vca_accent);
+        voice->vca_buf[sample] = vca_eg * vol_out*(1.0f + synth->accent*voice->vca_accent);
 
         if (!vca_eg_phase && vca_eg > vca_eg_amp) vca_eg_phase = 1;  /* flip from attack to decay */
         if (!vcf_eg_phase && vcf_eg > vcf_eg_amp) vcf_eg_phase = 1;  /* flip from attack to decay */
@@ -50,7 +50,7 @@ void DistrhoPluginPingPongPan::initParameter(uint32_t index, Parameter& paramete
     switch (index)
     {
     case paramFreq:
-        parameter.hints      = kParameterIsAutomatable;
+        parameter.hints      = kParameterIsAutomatable|kParameterIsModulatable;
         parameter.name       = "Frequency";
         parameter.symbol     = "freq";
         parameter.ranges.def = 50.0f;
@@ -59,7 +59,7 @@ void DistrhoPluginPingPongPan::initParameter(uint32_t index, Parameter& paramete
         break;
 
     case paramWidth:
-        parameter.hints      = kParameterIsAutomatable;
+        parameter.hints      = kParameterIsAutomatable|kParameterIsModulatable;
         parameter.name       = "Width";
         parameter.symbol     = "width";
         parameter.unit       = "%";
@@ -144,11 +144,16 @@ void DistrhoPluginPingPongPan::run(const float** inputs, float** outputs, uint32
     float*       out1 = outputs[0];
     float*       out2 = outputs[1];
 
+    // host modulation applies to the whole block
+    const float freq  = getParameterModulatedValue(paramFreq, fFreq);
+    const float width = getParameterModulatedValue(paramWidth, fWidth) / 100.0f;
+    const float speed = d_isEqual(freq, fFreq) ? waveSpeed : (k2PI * freq / 100.0f)/(float)getSampleRate();
+
     for (uint32_t i=0; i < frames; ++i)
     {
-        pan = std::fmin(std::fmax(std::sin(wavePos) * (fWidth/100.0f), -1.0f), 1.0f);
+        pan = std::fmin(std::fmax(std::sin(wavePos) * width, -1.0f), 1.0f);
 
-        if ((wavePos += waveSpeed) >= k2PI)
+        if ((wavePos += speed) >= k2PI)
             wavePos -= k2PI;
 
         out1[i] = in1[i] * (pan > 0.0f ? 1.0f-pan : 1.0f);
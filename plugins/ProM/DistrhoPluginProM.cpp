@@ -16,21 +16,23 @@
 
 #include "DistrhoPluginProM.hpp"
 
-#include "libprojectM/projectM.hpp"
-
 START_NAMESPACE_DISTRHO
 
 // -----------------------------------------------------------------------
 
+// size of the audio ring buffer, in samples, enough for a few frames worth of audio
+static constexpr const uint32_t kRingBufferSize = 16384;
+
+// -----------------------------------------------------------------------
+
 DistrhoPluginProM::DistrhoPluginProM()
-    : Plugin(0, 0, 0),
-      fPM(nullptr)
+    : Plugin(0, 0, 0)
 {
+    fRingBuffer.createBuffer(kRingBufferSize * sizeof(float));
 }
 
 DistrhoPluginProM::~DistrhoPluginProM()
 {
-    DISTRHO_SAFE_ASSERT(fPM == nullptr);
 }
 
 // -----------------------------------------------------------------------
@@ -74,13 +76,27 @@ void DistrhoPluginProM::run(const float** inputs, float** outputs, uint32_t fram
     if (out2 != in2)
         std::memcpy(out2, in2, sizeof(float)*frames);
 
-    const MutexLocker csm(fMutex);
-
-    if (fPM == nullptr)
-        return;
-
-    if (PCM* const pcm = const_cast<PCM*>(fPM->pcm()))
-        pcm->addPCMfloat(in1, frames);
+    // only the most recent audio matters for the visualizer
+    if (frames > kRingBufferSize / 4)
+    {
+        in1 += frames - kRingBufferSize / 4;
+        in2 += frames - kRingBufferSize / 4;
+        frames = kRingBufferSize / 4;
+    }
+
+    for (uint32_t offset = 0; offset < frames; offset += kMaxFramesPerWrite)
+    {
+        const uint32_t count = std::min(frames - offset, kMaxFramesPerWrite);
+
+        // drop audio instead of waiting if the UI is not reading (closed or too slow)
+        if (fRingBuffer.getWritableDataSize() <= sizeof(uint32_t) + sizeof(float)*count*2)
+            return;
+
+        fRingBuffer.writeUInt(count);
+        fRingBuffer.writeCustomData(in1 + offset, sizeof(float)*count);
+        fRingBuffer.writeCustomData(in2 + offset, sizeof(float)*count);
+        fRingBuffer.commitWrite();
+    }
 }
 
 // -----------------------------------------------------------------------
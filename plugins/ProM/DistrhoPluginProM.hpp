@@ -19,15 +19,19 @@
 
 #include "DistrhoPlugin.hpp"
 
-#include "extra/Mutex.hpp"
+#include "extra/RingBuffer.hpp"
 
-class projectM;
 class DistrhoUIProM;
 
 START_NAMESPACE_DISTRHO
 
 // -----------------------------------------------------------------------
 
+// maximum number of frames per ring buffer write, the UI reads each one into a stack buffer
+static constexpr const uint32_t kMaxFramesPerWrite = 1024;
+
+// -----------------------------------------------------------------------
+
 class DistrhoPluginProM : public Plugin
 {
 public:
@@ -93,8 +97,9 @@ protected:
     // -------------------------------------------------------------------
 
 private:
-    Mutex fMutex;
-    projectM* fPM;
+    // audio thread writes, UI thread reads right before rendering a frame
+    // each write is a frame count followed by the left and right channel data
+    HeapRingBuffer fRingBuffer;
     friend class DistrhoUIProM;
 
     DISTRHO_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DistrhoPluginProM)
@@ -51,14 +51,6 @@ DistrhoUIProM::DistrhoUIProM()
 
 DistrhoUIProM::~DistrhoUIProM()
 {
-    if (fPM == nullptr)
-        return;
-
-    if (DistrhoPluginProM* const dspPtr = (DistrhoPluginProM*)getPluginInstancePointer())
-    {
-        const MutexLocker csm(dspPtr->fMutex);
-        dspPtr->fPM = nullptr;
-    }
 }
 
 // -----------------------------------------------------------------------
@@ -77,15 +69,6 @@ void DistrhoUIProM::uiIdle()
         return;
 
     repaint();
-
-    if (DistrhoPluginProM* const dspPtr = (DistrhoPluginProM*)getPluginInstancePointer())
-    {
-        if (dspPtr->fPM != nullptr)
-            return;
-
-        const MutexLocker csm(dspPtr->fMutex);
-        dspPtr->fPM = fPM;
-    }
 }
 
 void DistrhoUIProM::uiReshape(const uint width, const uint height)
@@ -128,6 +111,43 @@ void DistrhoUIProM::onDisplay()
     if (fPM == nullptr)
         return;
 
+    // feed all audio received since the last frame
+    if (DistrhoPluginProM* const dspPtr = (DistrhoPluginProM*)getPluginInstancePointer())
+    {
+        HeapRingBuffer& ringBuffer(dspPtr->fRingBuffer);
+
+        if (PCM* const pcm = fPM->pcm())
+        {
+            float left[kMaxFramesPerWrite];
+            float right[kMaxFramesPerWrite];
+           #ifndef HAVE_PROJECTM_RESAMPLING
+            float interleaved[kMaxFramesPerWrite * 2];
+           #endif
+
+            while (ringBuffer.isDataAvailableForReading())
+            {
+                const uint32_t frames = ringBuffer.readUInt();
+                DISTRHO_SAFE_ASSERT_BREAK(frames != 0 && frames <= kMaxFramesPerWrite);
+
+                if (! ringBuffer.readCustomData(left, sizeof(float)*frames))
+                    break;
+                if (! ringBuffer.readCustomData(right, sizeof(float)*frames))
+                    break;
+
+               #ifdef HAVE_PROJECTM_RESAMPLING
+                pcm->addPCMfloat_2ch(left, right, frames, getSampleRate());
+               #else
+                for (uint32_t i = 0; i < frames; ++i)
+                {
+                    interleaved[i * 2 + 0] = left[i];
+                    interleaved[i * 2 + 1] = right[i];
+                }
+                pcm->addPCMfloat_2ch(interleaved, frames * 2);
+               #endif
+            }
+        }
+    }
+
     fPM->renderFrame();
 
     // some projectM versions do not turn off the last set GL program
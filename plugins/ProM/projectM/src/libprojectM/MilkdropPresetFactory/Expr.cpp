@@ -22,6 +22,9 @@
 #include "wipemalloc.h"
 
 #include "Expr.hpp"
+#include "ExprBytecode.hpp"
+#include "WorkerPool.hpp"
+#include <algorithm>
 #include <cassert>
 
 #include "Eval.hpp"
@@ -51,6 +54,7 @@ public:
     /* Evaluates functions in prefix form */
     Expr *_optimize() override;
     float eval(int mesh_i, int mesh_j) override;
+    int _bytecode(BytecodeProgram &bc) override;
     std::ostream& to_string(std::ostream &out) override;
 #if HAVE_LLVM
     llvm::Value *_llvm(JitContext &jitx) override;
@@ -192,6 +196,14 @@ public:
 		else
 			return expr_list[3]->eval(mesh_i,mesh_j);
 	}
+    int _bytecode(BytecodeProgram &bc) override
+    {
+        int a = Expr::bytecode(bc, expr_list[0]);
+        int b = Expr::bytecode(bc, expr_list[1]);
+        int t = Expr::bytecode(bc, expr_list[2]);
+        int e = Expr::bytecode(bc, expr_list[3]);
+        return bc.emit(BC_IF_ABOVE, a, b, t, e);
+    }
 #if HAVE_LLVM
     llvm::Value *_llvm(JitContext &jitx) override
     {
@@ -235,6 +247,14 @@ public:
 		else
 			return expr_list[3]->eval(mesh_i,mesh_j);
 	}
+    int _bytecode(BytecodeProgram &bc) override
+    {
+        int a = Expr::bytecode(bc, expr_list[0]);
+        int b = Expr::bytecode(bc, expr_list[1]);
+        int t = Expr::bytecode(bc, expr_list[2]);
+        int e = Expr::bytecode(bc, expr_list[3]);
+        return bc.emit(BC_IF_EQUAL, a, b, t, e);
+    }
 #if HAVE_LLVM
     llvm::Value *_llvm(JitContext &jitx) override
     {
@@ -271,6 +291,14 @@ public:
 		return expr_list[1]->eval ( mesh_i, mesh_j );
 	}
 
+    int _bytecode(BytecodeProgram &bc) override
+    {
+        int test = Expr::bytecode(bc, expr_list[0]);
+        int t = Expr::bytecode(bc, expr_list[1]);
+        int e = Expr::bytecode(bc, expr_list[2]);
+        return bc.emit(BC_IF, test, t, e);
+    }
+
 	Expr *_optimize() override
 	{
 		Expr *opt = PrefunExpr::_optimize();
@@ -373,6 +401,10 @@ public:
     {
         out << constant; return out;
     }
+    int _bytecode(BytecodeProgram &bc) override
+    {
+        return bc.constant(constant);
+    }
 
 #if HAVE_LLVM
     llvm::Value *_llvm(JitContext &jitx) override
@@ -408,6 +440,13 @@ public:
         out << "(" << a << " * " << b << ") + " << c;
         return out;
     }
+    int _bytecode(BytecodeProgram &bc) override
+    {
+        int avalue = Expr::bytecode(bc, a);
+        int bvalue = Expr::bytecode(bc, b);
+        int cvalue = Expr::bytecode(bc, c);
+        return bc.emit(BC_MUL_ADD, avalue, bvalue, cvalue);
+    }
 #if HAVE_LLVM
     llvm::Value *_llvm(JitContext &jitx) override
     {
@@ -444,6 +483,11 @@ public:
         out << "(" << expr << " * " << c << ") + " << c;
         return out;
     }
+    int _bytecode(BytecodeProgram &bc) override
+    {
+        int value = Expr::bytecode(bc, expr);
+        return bc.emit(BC_MUL, value, bc.constant(c));
+    }
 #if HAVE_LLVM
     llvm::Value *_llvm(JitContext &jitx) override
     {
@@ -604,6 +648,34 @@ float TreeExpr::eval ( int mesh_i, int mesh_j )
     }
 }
 
+int TreeExpr::_bytecode(BytecodeProgram &bc)
+{
+    if (NULL == infix_op)
+        return Expr::bytecode(bc, gen_expr);
+
+    int lhs = Expr::bytecode(bc, left);
+    int rhs = Expr::bytecode(bc, right);
+    switch (infix_op->type)
+    {
+        case INFIX_ADD:
+            return bc.emit(BC_ADD, lhs, rhs);
+        case INFIX_MINUS:
+            return bc.emit(BC_SUB, lhs, rhs);
+        case INFIX_MULT:
+            return bc.emit(BC_MUL, lhs, rhs);
+        case INFIX_MOD:
+            return bc.emit(BC_MOD, lhs, rhs);
+        case INFIX_OR:
+            return bc.emit(BC_OR, lhs, rhs);
+        case INFIX_AND:
+            return bc.emit(BC_AND, lhs, rhs);
+        case INFIX_DIV:
+            return bc.emit(BC_DIV, lhs, rhs);
+        default:
+            return -1;
+    }
+}
+
 #if HAVE_LLVM
 llvm::Value *TreeExpr::_llvm(JitContext &jitx)
 {
@@ -879,6 +951,45 @@ Expr *PrefunExpr::_optimize()
     return this;
 }
 
+int PrefunExpr::_bytecode(BytecodeProgram &bc)
+{
+    if (num_args > 3)
+        return -1;
+    int args[3];
+    for (int i=0 ; i < num_args ; i++)
+        args[i] = Expr::bytecode(bc, expr_list[i]);
+
+    if (num_args == 1)
+    {
+        if (func_ptr == FuncWrappers::sin_wrapper)
+            return bc.emit(BC_SIN, args[0]);
+        if (func_ptr == (float (*)(float *)) FuncWrappers::cos_wrapper)
+            return bc.emit(BC_COS, args[0]);
+        if (func_ptr == (float (*)(float *)) FuncWrappers::log_wrapper)
+            return bc.emit(BC_LOG, args[0]);
+        if (func_ptr == (float (*)(float *)) FuncWrappers::abs_wrapper)
+            return bc.emit(BC_ABS, args[0]);
+        if (func_ptr == (float (*)(float *)) FuncWrappers::sqr_wrapper)
+            return bc.emit(BC_SQR, args[0]);
+        if (func_ptr == (float (*)(float *)) FuncWrappers::sqrt_wrapper)
+            return bc.emit(BC_SQRT, args[0]);
+    }
+    else if (num_args == 2)
+    {
+        if (func_ptr == (float (*)(float *)) FuncWrappers::min_wrapper)
+            return bc.emit(BC_MIN, args[0], args[1]);
+        if (func_ptr == (float (*)(float *)) FuncWrappers::max_wrapper)
+            return bc.emit(BC_MAX, args[0], args[1]);
+        if (func_ptr == (float (*)(float *)) FuncWrappers::above_wrapper)
+            return bc.emit(BC_ABOVE, args[0], args[1]);
+        if (func_ptr == (float (*)(float *)) FuncWrappers::below_wrapper)
+            return bc.emit(BC_BELOW, args[0], args[1]);
+        if (func_ptr == (float (*)(float *)) FuncWrappers::equal_wrapper)
+            return bc.emit(BC_EQUAL, args[0], args[1]);
+    }
+    return bc.emit_call(func_ptr, num_args, args, !isConstantFn(func_ptr));
+}
+
 std::ostream& PrefunExpr::to_string(std::ostream& out)
 {
     char comma = ' ';
@@ -972,6 +1083,12 @@ public:
         return out;
     }
 
+    int _bytecode(BytecodeProgram &bc) override
+    {
+        int value = Expr::bytecode(bc, rhs);
+        return bc.store(lhs, value);
+    }
+
 #if HAVE_LLVM
     llvm::Value *_llvm(JitContext &jitx) override
     {
@@ -1029,6 +1146,13 @@ public:
             f = (*it)->eval(mesh_i,mesh_j);
         return f;
     }
+    int _bytecode(BytecodeProgram &bc) override
+    {
+        int v = bc.constant(0.0f);
+        for (auto it=steps.begin() ; it<steps.end() && v >= 0 ; it++)
+            v = Expr::bytecode(bc, *it);
+        return v;
+    }
 #if HAVE_LLVM
     llvm::Value *_llvm(JitContext &jitx) override
     {
@@ -1047,6 +1171,99 @@ Expr *Expr::create_program_expr(std::vector<Expr*> &steps_, bool ownSteps)
 }
 
 
+class BytecodeExpr : public Expr
+{
+    BytecodeProgram *program;
+    Expr *expr;
+    // registers of each thread of the WorkerPool
+    std::vector<std::vector<float> > scratch;
+
+public:
+    BytecodeExpr(BytecodeProgram *program_, Expr *orig) : Expr(BYTECODE), program(program_), expr(orig)
+    {
+    }
+
+    ~BytecodeExpr() override
+    {
+        Expr::delete_expr(expr);
+        delete program;
+    }
+
+    float eval(int mesh_i, int mesh_j) override
+    {
+        return expr->eval(mesh_i, mesh_j);
+    }
+
+    void eval_row(int mesh_i, int count) override
+    {
+        for (int mesh_j = 0; mesh_j < count; mesh_j += BYTECODE_LANES)
+            program->run(mesh_i, mesh_j, std::min(count - mesh_j, BYTECODE_LANES));
+    }
+
+    void eval_mesh(int count_i, int count_j) override
+    {
+        if (program->is_serial() || count_i < 2)
+        {
+            Expr::eval_mesh(count_i, count_j);
+            return;
+        }
+
+        // the first row sets the matrix flags of assigned params, so that other rows only read them
+        eval_row(0, count_j);
+
+        WorkerPool &pool = WorkerPool::shared();
+        if (scratch.size() < (size_t)pool.size())
+            scratch.resize(pool.size(), program->new_registers());
+
+        pool.parallel_for(count_i - 1, [this, count_i, count_j](int begin, int end, int thread)
+        {
+            std::vector<float> &registers = scratch[thread];
+            int count = 0;
+            for (int mesh_i = begin + 1; mesh_i < end + 1; mesh_i++)
+            {
+                for (int mesh_j = 0; mesh_j < count_j; mesh_j += count)
+                {
+                    count = std::min(count_j - mesh_j, BYTECODE_LANES);
+                    program->run(registers, mesh_i, mesh_j, count);
+                }
+            }
+            // only the thread evaluating the last row writes scalars back
+            if (end + 1 == count_i && count > 0)
+                program->store_vars(registers, count);
+        });
+    }
+
+#if HAVE_LLVM
+    llvm::Value *_llvm(JitContext &jit) override
+    {
+        assert(false);
+        return nullptr;
+    }
+#endif
+};
+
+
+/* this is mostly a passthrough, but can be used to intercept calls to Param */
+int Expr::bytecode(BytecodeProgram &bc, Expr *root)
+{
+    if (root->clazz == PARAMETER)
+        return bc.load((Param *)root);
+    return root->_bytecode(bc);
+}
+
+
+Expr *Expr::compile(Expr *root)
+{
+    auto *program = new BytecodeProgram();
+    if (Expr::bytecode(*program, root) < 0)
+    {
+        delete program;
+        return nullptr;
+    }
+    return new BytecodeExpr(program, root);
+}
+
+
 
 
 // TESTS
@@ -39,6 +39,7 @@ class Test;
 class Param;
 class LValue;
 class JitContext;
+class BytecodeProgram;
 
 #ifdef HAVE_LLVM
 namespace llvm {
@@ -74,7 +75,7 @@ public:
 
 enum ExprClass
 {
-  TREE, CONSTANT, PARAMETER, FUNCTION, ASSIGN, PROGRAM, JIT, OTHER
+  TREE, CONSTANT, PARAMETER, FUNCTION, ASSIGN, PROGRAM, JIT, BYTECODE, OTHER
 };
 
 class Expr
@@ -86,6 +87,18 @@ public:
 
   virtual bool isConstant() { return false; };
   virtual float eval(int mesh_i, int mesh_j) = 0;
+  // evaluates count vertices of mesh row mesh_i
+  virtual void eval_row(int mesh_i, int count)
+  {
+      for (int mesh_j = 0; mesh_j < count; mesh_j++)
+          eval(mesh_i, mesh_j);
+  }
+  // evaluates a whole mesh, rows may be evaluated concurrently if that gives the same result
+  virtual void eval_mesh(int count_i, int count_j)
+  {
+      for (int mesh_i = 0; mesh_i < count_i; mesh_i++)
+          eval_row(mesh_i, count_j);
+  }
   virtual std::ostream& to_string(std::ostream &out)
   {
       std::cout << "nyi"; return out;
@@ -103,10 +116,14 @@ public:
   static void delete_expr(Expr *expr) { if (nullptr != expr) expr->_delete_from_tree(); }
   static Expr *optimize(Expr *root);
   static Expr *jit(Expr *root, std::string name="Expr::jit");
+  // returns nullptr if root can not be evaluated a row at a time
+  static Expr *compile(Expr *root);
 
 public: // but don't call these from outside Expr.cpp
 
   virtual Expr *_optimize() { return this; };
+  static int bytecode(BytecodeProgram &bc, Expr *);
+  virtual int _bytecode(BytecodeProgram &bc) { return -1; }  //ONLY called by bytecode()
 #if HAVE_LLVM
   static  llvm::Value *llvm(JitContext &jit, Expr *);
   virtual llvm::Value *_llvm(JitContext &jit) = 0;  //ONLY called by llvm()
@@ -154,6 +171,7 @@ public:
   
   Expr *_optimize() override;
   float eval(int mesh_i, int mesh_j) override;
+  int _bytecode(BytecodeProgram &bc) override;
 #if HAVE_LLVM
   llvm::Value *_llvm(JitContext &jitx) override;
 #endif
@@ -0,0 +1,399 @@
+/**
+ * projectM -- Milkdrop-esque visualisation SDK
+ * Copyright (C)2003-2007 projectM Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * See 'LICENSE.txt' included within this release
+ *
+ */
+
+#include "ExprBytecode.hpp"
+#include "Param.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+
+BytecodeProgram::BytecodeProgram() : num_regs(0), serial(false)
+{
+}
+
+
+int BytecodeProgram::alloc(bool is_temp)
+{
+    if (is_temp && !free_regs.empty())
+    {
+        int index = free_regs.back();
+        free_regs.pop_back();
+        return index;
+    }
+    int index = num_regs++;
+    regs.resize(num_regs * BYTECODE_LANES, 0.0f);
+    temp.push_back(is_temp);
+    return index;
+}
+
+
+void BytecodeProgram::release(int index)
+{
+    // registers holding constants or param values are read any number of times, temporaries exactly once
+    if (index >= 0 && temp[index])
+        free_regs.push_back(index);
+}
+
+
+int BytecodeProgram::constant(float value)
+{
+    for (auto it = constants.begin(); it != constants.end(); ++it)
+        if (it->second == value)
+            return it->first;
+
+    int index = alloc(false);
+    float *r = reg(regs, index);
+    for (int k = 0; k < BYTECODE_LANES; k++)
+        r[k] = value;
+    constants.push_back(std::make_pair(index, value));
+    return index;
+}
+
+
+int BytecodeProgram::load(Param *param)
+{
+    auto it = values.find(param);
+    if (it != values.end())
+        return it->second;
+
+    if (param->flags & P_FLAG_PER_POINT)
+        return -1;
+
+    BytecodeInstr instr = {};
+    instr.param = param;
+    if ((param->flags & P_FLAG_PER_PIXEL) && nullptr != param->matrix)
+    {
+        instr.op = BC_LOAD_MESH;
+    }
+    else
+    {
+        // not assigned by the program so far, so it must not be assigned later on either
+        instr.op = BC_UNIFORM;
+    }
+    instr.dst = alloc(false);
+
+    code.push_back(instr);
+    values[param] = instr.dst;
+    return instr.dst;
+}
+
+
+int BytecodeProgram::store(LValue *lhs, int index)
+{
+    Param *param = dynamic_cast<Param *>(lhs);
+    if (nullptr == param || index < 0 || param->type != P_TYPE_DOUBLE)
+        return -1;
+
+    BytecodeInstr instr = {};
+    instr.param = param;
+    instr.a = index;
+
+    if ((param->flags & P_FLAG_PER_PIXEL) && nullptr != param->matrix)
+    {
+        // the register now holds the value of param, keep it around
+        instr.op = BC_STORE_MESH;
+        instr.dst = index;
+        temp[index] = false;
+    }
+    else if (param->flags & P_FLAG_PER_POINT)
+    {
+        return -1;
+    }
+    else
+    {
+        // a scalar read before being assigned carries its value from one vertex to the next,
+        // which can not be evaluated a row at a time
+        auto it = values.find(param);
+        if (it != values.end())
+        {
+            bool assigned = false;
+            for (auto var = vars.begin(); var != vars.end(); ++var)
+                assigned = assigned || var->param == param;
+            if (!assigned)
+                return -1;
+        }
+
+        instr.op = BC_STORE_VAR;
+        release(index);
+        instr.dst = alloc(false);
+
+        bool found = false;
+        for (auto var = vars.begin(); var != vars.end(); ++var)
+        {
+            if (var->param == param)
+            {
+                var->reg = instr.dst;
+                found = true;
+            }
+        }
+        if (!found)
+        {
+            Var var = { param, instr.dst };
+            vars.push_back(var);
+        }
+    }
+
+    code.push_back(instr);
+    values[param] = instr.dst;
+    return instr.dst;
+}
+
+
+int BytecodeProgram::emit(BytecodeOp op, int a, int b, int c, int d)
+{
+    int num_operands = 2;
+    if (op >= BC_SIN && op <= BC_SQRT)
+        num_operands = 1;
+    else if (op == BC_MUL_ADD || op == BC_IF)
+        num_operands = 3;
+    else if (op == BC_IF_ABOVE || op == BC_IF_EQUAL)
+        num_operands = 4;
+
+    const int args[4] = { a, b, c, d };
+    for (int i = 0; i < num_operands; i++)
+    {
+        if (args[i] < 0)
+            return -1;
+    }
+
+    BytecodeInstr instr = {};
+    instr.op = op;
+    instr.a = a;
+    instr.b = b;
+    instr.c = c;
+    instr.d = d;
+
+    // operands are read before the result is written, so the result may reuse one of them
+    for (int i = 0; i < 4; i++)
+        release(args[i]);
+    instr.dst = alloc(true);
+
+    code.push_back(instr);
+    return instr.dst;
+}
+
+
+int BytecodeProgram::emit_call(float (*func)(float *), int num_args, const int *args, bool side_effects)
+{
+    if (num_args < 1 || num_args > 3)
+        return -1;
+    for (int i = 0; i < num_args; i++)
+    {
+        if (args[i] < 0)
+            return -1;
+    }
+
+    BytecodeInstr instr = {};
+    instr.op = BC_CALL;
+    instr.func = func;
+    instr.num_args = num_args;
+    instr.a = args[0];
+    instr.b = num_args > 1 ? args[1] : -1;
+    instr.c = num_args > 2 ? args[2] : -1;
+
+    for (int i = 0; i < num_args; i++)
+        release(args[i]);
+    instr.dst = alloc(true);
+    serial = serial || side_effects;
+
+    code.push_back(instr);
+    return instr.dst;
+}
+
+
+void BytecodeProgram::run(int mesh_i, int mesh_j, int count)
+{
+    run(regs, mesh_i, mesh_j, count);
+    store_vars(regs, count);
+}
+
+
+void BytecodeProgram::run(std::vector<float> &registers, int mesh_i, int mesh_j, int count)
+{
+    assert(count > 0 && count <= BYTECODE_LANES);
+    assert(registers.size() == regs.size());
+    const int n = count;
+
+    for (auto it = code.begin(); it != code.end(); ++it)
+    {
+        const BytecodeInstr &instr = *it;
+        float *dst = reg(registers, instr.dst);
+        const float *a = reg(registers, instr.a);
+        const float *b = instr.b >= 0 ? reg(registers, instr.b) : nullptr;
+        const float *c = instr.c >= 0 ? reg(registers, instr.c) : nullptr;
+        const float *d = instr.d >= 0 ? reg(registers, instr.d) : nullptr;
+
+        switch (instr.op)
+        {
+        case BC_UNIFORM:
+        {
+            const float value = instr.param->eval(-1, -1);
+            for (int k = 0; k < n; k++)
+                dst[k] = value;
+            break;
+        }
+        case BC_LOAD_MESH:
+            if (instr.param->matrix_flag)
+            {
+                std::memcpy(dst, ((float **)instr.param->matrix)[mesh_i] + mesh_j, n * sizeof(float));
+            }
+            else
+            {
+                const float value = *(float *)instr.param->engine_val;
+                for (int k = 0; k < n; k++)
+                    dst[k] = value;
+            }
+            break;
+        case BC_STORE_MESH:
+            std::memcpy(((float **)instr.param->matrix)[mesh_i] + mesh_j, a, n * sizeof(float));
+            // rows may be evaluated concurrently, avoid writing the flag again
+            if (!instr.param->matrix_flag)
+                instr.param->matrix_flag = true;
+            break;
+        case BC_STORE_VAR:
+        {
+            // same clipping as Param::set_param()
+            const float lower = instr.param->lower_bound.float_val;
+            const float upper = instr.param->upper_bound.float_val;
+            for (int k = 0; k < n; k++)
+                dst[k] = a[k] < lower ? lower : (a[k] > upper ? upper : a[k]);
+            break;
+        }
+        case BC_ADD:
+            for (int k = 0; k < n; k++)
+                dst[k] = a[k] + b[k];
+            break;
+        case BC_SUB:
+            for (int k = 0; k < n; k++)
+                dst[k] = a[k] - b[k];
+            break;
+        case BC_MUL:
+            for (int k = 0; k < n; k++)
+                dst[k] = a[k] * b[k];
+            break;
+        case BC_DIV:
+            for (int k = 0; k < n; k++)
+                dst[k] = b[k] == 0 ? MAX_DOUBLE_SIZE : a[k] / b[k];
+            break;
+        case BC_MOD:
+            for (int k = 0; k < n; k++)
+            {
+                // x % -1 is always 0, but INT_MIN % -1 traps
+                const int l = (int)a[k], r = (int)b[k];
+                dst[k] = (r == 0 || r == -1) ? 0 : l % r;
+            }
+            break;
+        case BC_OR:
+            for (int k = 0; k < n; k++)
+                dst[k] = (int)a[k] | (int)b[k];
+            break;
+        case BC_AND:
+            for (int k = 0; k < n; k++)
+                dst[k] = (int)a[k] & (int)b[k];
+            break;
+        case BC_MUL_ADD:
+            for (int k = 0; k < n; k++)
+                dst[k] = a[k] * b[k] + c[k];
+            break;
+        case BC_SIN:
+            for (int k = 0; k < n; k++)
+                dst[k] = sinf(a[k]);
+            break;
+        case BC_COS:
+            for (int k = 0; k < n; k++)
+                dst[k] = cosf(a[k]);
+            break;
+        case BC_LOG:
+            for (int k = 0; k < n; k++)
+                dst[k] = logf(a[k]);
+            break;
+        case BC_ABS:
+            for (int k = 0; k < n; k++)
+                dst[k] = fabsf(a[k]);
+            break;
+        case BC_SQR:
+            for (int k = 0; k < n; k++)
+                dst[k] = a[k] * a[k];
+            break;
+        case BC_SQRT:
+            for (int k = 0; k < n; k++)
+                dst[k] = sqrtf(a[k]);
+            break;
+        case BC_MIN:
+            for (int k = 0; k < n; k++)
+                dst[k] = a[k] > b[k] ? b[k] : a[k];
+            break;
+        case BC_MAX:
+            for (int k = 0; k < n; k++)
+                dst[k] = a[k] > b[k] ? a[k] : b[k];
+            break;
+        case BC_ABOVE:
+            for (int k = 0; k < n; k++)
+                dst[k] = a[k] > b[k] ? 1.0f : 0.0f;
+            break;
+        case BC_BELOW:
+            for (int k = 0; k < n; k++)
+                dst[k] = a[k] < b[k] ? 1.0f : 0.0f;
+            break;
+        case BC_EQUAL:
+            for (int k = 0; k < n; k++)
+                dst[k] = a[k] == b[k] ? 1.0f : 0.0f;
+            break;
+        // both sides of a condition are evaluated, they have no side effects except for rand()
+        case BC_IF:
+            for (int k = 0; k < n; k++)
+                dst[k] = a[k] != 0 ? b[k] : c[k];
+            break;
+        case BC_IF_ABOVE:
+            for (int k = 0; k < n; k++)
+                dst[k] = a[k] > b[k] ? c[k] : d[k];
+            break;
+        case BC_IF_EQUAL:
+            for (int k = 0; k < n; k++)
+                dst[k] = a[k] == b[k] ? c[k] : d[k];
+            break;
+        case BC_CALL:
+        {
+            float args[3];
+            for (int k = 0; k < n; k++)
+            {
+                args[0] = a[k];
+                if (instr.num_args > 1)
+                    args[1] = b[k];
+                if (instr.num_args > 2)
+                    args[2] = c[k];
+                dst[k] = instr.func(args);
+            }
+            break;
+        }
+        }
+    }
+}
+
+
+void BytecodeProgram::store_vars(std::vector<float> &registers, int count)
+{
+    // scalars keep the value of the last vertex, as if evaluated one vertex at a time
+    for (auto it = vars.begin(); it != vars.end(); ++it)
+        it->param->set_param(reg(registers, it->reg)[count - 1]);
+}
@@ -0,0 +1,120 @@
+/**
+ * projectM -- Milkdrop-esque visualisation SDK
+ * Copyright (C)2003-2007 projectM Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * See 'LICENSE.txt' included within this release
+ *
+ */
+/**
+ * $Id$
+ *
+ * Register based bytecode for per-pixel programs
+ *
+ * Expr trees are compiled (see Expr::compile) into a flat list of instructions
+ * working on registers that hold BYTECODE_LANES values each, so that a whole mesh
+ * row is evaluated one instruction at a time instead of walking the tree per vertex.
+ * Every instruction is a simple loop over float arrays which the compiler can vectorize.
+ *
+ * $Log$
+ */
+
+#ifndef _EXPR_BYTECODE_H
+#define _EXPR_BYTECODE_H
+
+#include <map>
+#include <vector>
+
+class LValue;
+class Param;
+
+/* number of mesh vertices evaluated at once */
+#define BYTECODE_LANES 64
+
+enum BytecodeOp
+{
+    BC_UNIFORM,     /* broadcast the scalar value of param */
+    BC_LOAD_MESH,   /* load a row of the mesh of param */
+    BC_STORE_MESH,  /* store a into a row of the mesh of param */
+    BC_STORE_VAR,   /* clamp a to the bounds of param */
+    BC_ADD, BC_SUB, BC_MUL, BC_DIV, BC_MOD, BC_OR, BC_AND,
+    BC_MUL_ADD,
+    BC_SIN, BC_COS, BC_LOG, BC_ABS, BC_SQR, BC_SQRT,
+    BC_MIN, BC_MAX, BC_ABOVE, BC_BELOW, BC_EQUAL,
+    BC_IF, BC_IF_ABOVE, BC_IF_EQUAL,
+    BC_CALL         /* call func for every lane, with num_args registers out of a, b and c */
+};
+
+struct BytecodeInstr
+{
+    BytecodeOp op;
+    int dst, a, b, c, d;
+    Param *param;
+    float (*func)(float *);
+    int num_args;
+};
+
+class BytecodeProgram
+{
+public:
+    BytecodeProgram();
+
+    /* evaluates count vertices of mesh row mesh_i, starting at mesh_j */
+    void run(int mesh_i, int mesh_j, int count);
+
+    /* same as above with registers from new_registers(), so that rows can be evaluated concurrently.
+       assigned scalars are only written back by store_vars() */
+    void run(std::vector<float> &registers, int mesh_i, int mesh_j, int count);
+    void store_vars(std::vector<float> &registers, int count);
+    std::vector<float> new_registers() const { return regs; }
+
+    /* true if the program calls functions with side effects, like rand() */
+    bool is_serial() const { return serial; }
+
+    // code generation, registers are returned as indices and -1 means not supported
+
+    int constant(float value);
+    int load(Param *param);
+    int store(LValue *lhs, int reg);
+    int emit(BytecodeOp op, int a, int b = -1, int c = -1, int d = -1);
+    int emit_call(float (*func)(float *), int num_args, const int *args, bool side_effects);
+
+private:
+    struct Var
+    {
+        Param *param;
+        int reg;
+    };
+
+    std::vector<BytecodeInstr> code;
+    std::vector<float> regs;
+    std::vector<bool> temp;
+    std::vector<int> free_regs;
+    int num_regs;
+    bool serial;
+
+    // registers holding constants, initialized when allocated and never written by instructions
+    std::vector<std::pair<int, float> > constants;
+    // latest register holding the value of each param that was loaded or assigned
+    std::map<Param *, int> values;
+    // scalar params assigned by the program, the value of the last lane is written back after each run
+    std::vector<Var> vars;
+
+    int alloc(bool is_temp);
+    void release(int reg);
+    static float *reg(std::vector<float> &registers, int index) { return &registers[index * BYTECODE_LANES]; }
+};
+
+#endif /** _EXPR_BYTECODE_H */
@@ -509,16 +509,13 @@ void MilkdropPreset::evalPerPixelEqns()
         if (!steps.empty())
             jit = Expr::jit(program_expr, module_name);
 #endif
+        // Otherwise evaluate whole mesh rows through bytecode, if the program allows it
+        if (nullptr == jit && !steps.empty())
+            jit = Expr::compile(program_expr);
         per_pixel_program = jit ? jit : program_expr;
     }
 
-    for (int mesh_x = 0; mesh_x < presetInputs().gx; mesh_x++)
-    {
-        for (int mesh_y = 0; mesh_y < presetInputs().gy; mesh_y++)
-        {
-            per_pixel_program->eval(mesh_x, mesh_y);
-        }
-    }
+    per_pixel_program->eval_mesh(presetInputs().gx, presetInputs().gy);
 }
 
 int MilkdropPreset::readIn(std::istream& fs)
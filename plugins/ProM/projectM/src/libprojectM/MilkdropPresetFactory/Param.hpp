@@ -67,6 +67,7 @@ class Test;
 /* Parameter Type */
 class Param : public LValue
 {
+    friend class BytecodeProgram;
 protected:
     Param(const std::string &name, short int type, short int flags,
           void * eqn_val, void *matrix,
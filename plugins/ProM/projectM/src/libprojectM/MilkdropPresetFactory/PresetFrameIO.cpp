@@ -5,6 +5,7 @@
 #include <iostream>
 #include <cmath>
 #include "Renderer/BeatDetect.hpp"
+#include "WorkerPool.hpp"
 
 #ifdef __SSE2__
 #include <immintrin.h>
@@ -177,7 +178,7 @@ void PresetOutputs::Render(const BeatDetect &music, const PipelineContext &conte
 
 
 // N.B. The more optimization that can be done on this method, the better! This is called a lot and can probably be improved.
-void PresetOutputs::PerPixelMath_c(const PipelineContext &context)
+void PresetOutputs::PerPixelMath_c(const PipelineContext &context, int x_begin, int x_end)
 {
     const float fWarpTime = context.time * this->fWarpAnimSpeed;
     const float fWarpScaleInv = 1.0f / this->fWarpScale;
@@ -187,7 +188,7 @@ void PresetOutputs::PerPixelMath_c(const PipelineContext &context)
     f[2] = 10.54f + 3.0f * cosf(fWarpTime * 1.233f + 3);
     f[3] = 11.49f + 4.0f * cosf(fWarpTime * 0.933f + 5);
 
-    for (int x = 0; x < gx; x++)
+    for (int x = x_begin; x < x_end; x++)
 	{
 		for (int y = 0; y < gy; y++)
 		{
@@ -282,7 +283,7 @@ inline __m128 _mm_cosf(__m128 x)
 }
 
 
-void PresetOutputs::PerPixelMath_sse(const PipelineContext &context)
+void PresetOutputs::PerPixelMath_sse(const PipelineContext &context, int x_begin, int x_end)
 {
 	const float fWarpTime = context.time * this->fWarpAnimSpeed;
 	const float fWarpScaleInv = 1.0f / this->fWarpScale;
@@ -294,7 +295,7 @@ void PresetOutputs::PerPixelMath_sse(const PipelineContext &context)
 		11.49f + 4.0f * cosf(fWarpTime * 0.933f + 5)
 	};
 
-	for (int x = 0; x < gx; x++)
+	for (int x = x_begin; x < x_end; x++)
 	{
 		for (int y = 0; y < gy; y += 4)
 		{
@@ -442,11 +443,15 @@ void PresetOutputs::PerPixelMath_sse(const PipelineContext &context)
 
 void PresetOutputs::PerPixelMath(const PipelineContext &context)
 {
+	// every vertex only depends on its own inputs, so the mesh is split along x
+	WorkerPool::shared().parallel_for(gx, [this, &context](int x_begin, int x_end, int thread)
+	{
 #ifdef __SSE2__
-	PerPixelMath_sse(context);
+		PerPixelMath_sse(context, x_begin, x_end);
 #else
-	PerPixelMath_c(context);
+		PerPixelMath_c(context, x_begin, x_end);
 #endif
+	});
 }
 
 
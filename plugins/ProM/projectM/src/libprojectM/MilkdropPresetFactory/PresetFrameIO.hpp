@@ -140,9 +140,9 @@ public:
     float **rad_mesh;
 
 private:
-    void PerPixelMath_c( const PipelineContext &context);
+    void PerPixelMath_c( const PipelineContext &context, int x_begin, int x_end);
 #ifdef __SSE2__
-    void PerPixelMath_sse( const PipelineContext &context);
+    void PerPixelMath_sse( const PipelineContext &context, int x_begin, int x_end);
 #endif
 };
 
@@ -88,7 +88,7 @@ public:
 };
 
 
-PCM::PCM() : start(0), newsamples(0)
+PCM::PCM() : start(0), newsamples(0), resampleRate(0), resamplePos(0)
 {
     leveler = new AutoLevel();
 
@@ -110,6 +110,8 @@ PCM::PCM() : start(0), newsamples(0)
     memset(freqR, 0, sizeof(freqR));
     memset(spectrumL, 0, sizeof(spectrumL));
     memset(spectrumR, 0, sizeof(spectrumR));
+    memset(resampleAcc, 0, sizeof(resampleAcc));
+    memset(resamplePrev, 0, sizeof(resamplePrev));
 }
 
 
@@ -159,6 +161,96 @@ void PCM::addPCMfloat_2ch(const float *PCMdata, size_t count)
 }
 
 
+/* Decimation averages the input over each output sample period (box filter),
+ * which is enough to keep content above the analysis Nyquist out of the spectrum.
+ * Lower rates are linearly interpolated. */
+void PCM::addPCMfloat_2ch(const float *left, const float *right, size_t samples, double sampleRate)
+{
+    if (sampleRate <= 0 || samples == 0)
+        return;
+
+    if (sampleRate != resampleRate)
+    {
+        resampleRate = sampleRate;
+        resamplePos = 0;
+        resampleAcc[0] = resampleAcc[1] = 0;
+        resamplePrev[0] = resamplePrev[1] = 0;
+    }
+
+    const double step = sampleRate / analysisRate;
+    size_t written = 0;
+    float a,b,sum=0,max=0;
+
+#define PCM_WRITE_SAMPLE(L, R) \
+    { \
+        const size_t j = (start + written++) % maxsamples; \
+        a = pcmL[j] = (L); \
+        b = pcmR[j] = (R); \
+        sum += fabs(a) + fabs(b); \
+        max = fmax(fmax(max,fabs(a)),fabs(b)); \
+    }
+
+    if (step == 1.0)
+    {
+        for (size_t i=0; i<samples; i++)
+            PCM_WRITE_SAMPLE(left[i], right[i])
+    }
+    else if (step > 1.0)
+    {
+        // resamplePos is the amount of input still needed to complete the current output sample
+        const float scale = 1.0 / step;
+        double remaining = resamplePos > 0 ? resamplePos : step;
+
+        for (size_t i=0; i<samples; i++)
+        {
+            if (remaining > 1.0)
+            {
+                resampleAcc[0] += left[i];
+                resampleAcc[1] += right[i];
+                remaining -= 1.0;
+                continue;
+            }
+
+            const float part = remaining;
+            PCM_WRITE_SAMPLE((resampleAcc[0] + left[i] * part) * scale,
+                             (resampleAcc[1] + right[i] * part) * scale)
+
+            resampleAcc[0] = left[i] * (1.0f - part);
+            resampleAcc[1] = right[i] * (1.0f - part);
+            remaining = step - (1.0 - part);
+        }
+
+        resamplePos = remaining;
+    }
+    else
+    {
+        // resamplePos is the fractional position between the previous and current input sample
+        for (size_t i=0; i<samples; i++)
+        {
+            for (; resamplePos < 1.0; resamplePos += step)
+            {
+                const float frac = resamplePos;
+                PCM_WRITE_SAMPLE(resamplePrev[0] + (left[i] - resamplePrev[0]) * frac,
+                                 resamplePrev[1] + (right[i] - resamplePrev[1]) * frac)
+            }
+
+            resamplePos -= 1.0;
+            resamplePrev[0] = left[i];
+            resamplePrev[1] = right[i];
+        }
+    }
+
+#undef PCM_WRITE_SAMPLE
+
+    if (written == 0)
+        return;
+
+    start = (start + written) % maxsamples;
+    newsamples += written;
+    level = leveler->updateLevel(written, sum/2, max);
+}
+
+
 void PCM::addPCM16Data(const short* pcm_data, size_t samples)
 {
     float a, b, sum = 0, max = 0;
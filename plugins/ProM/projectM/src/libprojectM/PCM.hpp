@@ -52,11 +52,20 @@ public:
     /* maximum number of sound samples that are actually stored. */
     static const size_t maxsamples=2048;
 
+    /* rate at which all stored samples are analyzed, FFT bands and beat detection are tuned for it. */
+    static const unsigned analysisRate=44100;
+
     PCM();
     ~PCM();
 
     void addPCMfloat( const float *PCMdata, size_t samples );
     void addPCMfloat_2ch( const float *PCMdata, size_t count );
+    /**
+     * Non-interleaved stereo data at any sample rate.
+     * Data is resampled to analysisRate, so band energies and beat detection
+     * do not depend on the rate of the audio source.
+     */
+    void addPCMfloat_2ch( const float *left, const float *right, size_t samples, double sampleRate );
     void addPCM16( const short [2][512] );
     void addPCM16Data( const short* pcm_data, size_t samples );
     void addPCM8( const unsigned char [2][1024] );
@@ -118,6 +127,12 @@ private:
     // state for tracking audio level
     double level;
     class AutoLevel *leveler;
+
+    // state for resampling to analysisRate
+    double resampleRate;
+    double resamplePos;
+    float resampleAcc[2];
+    float resamplePrev[2];
 };
 
 #endif /** !_PCM_H */
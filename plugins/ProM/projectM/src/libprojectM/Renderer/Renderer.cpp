@@ -9,8 +9,7 @@
 #include <algorithm>
 #include <sys/stat.h>
 #include <cassert>
-#include "omptl/omptl"
-#include "omptl/omptl_algorithm"
+#include "WorkerPool.hpp"
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
@@ -473,6 +472,8 @@ void Renderer::RenderFrame(const Pipeline& pipeline,
 
 void Renderer::RenderFrameOnlyPass1(const Pipeline& pipeline, const PipelineContext& pipelineContext)
 {
+	textureManager->uploadLoadedTextures();
+
 	shaderEngine.RenderBlurTextures(pipeline, pipelineContext);
 
 	SetupPass1(pipeline, pipelineContext);
@@ -517,49 +518,57 @@ void Renderer::Interpolation(const Pipeline& pipeline, const PipelineContext& pi
 
 	int size = (mesh.height - 1) * mesh.width * 4 * 2;
 
+	// rows of the mesh are independent, split them across the worker pool
 	if (pipeline.staticPerPixel)
 	{
-		for (int j = 0; j < mesh.height - 1; j++)
+		WorkerPool::shared().parallel_for(mesh.height - 1, [this, &pipeline](int j_begin, int j_end, int thread)
 		{
-			int base = j * mesh.width * 2 * 4;
-
-			for (int i = 0; i < mesh.width; i++)
+			for (int j = j_begin; j < j_end; j++)
 			{
-				int strip = base + i * 8;
-				p[strip + 2] = pipeline.x_mesh[i][j];
-				p[strip + 3] = pipeline.y_mesh[i][j];
+				int base = j * mesh.width * 2 * 4;
 
-				p[strip + 6] = pipeline.x_mesh[i][j + 1];
-				p[strip + 7] = pipeline.y_mesh[i][j + 1];
+				for (int i = 0; i < mesh.width; i++)
+				{
+					int strip = base + i * 8;
+					p[strip + 2] = pipeline.x_mesh[i][j];
+					p[strip + 3] = pipeline.y_mesh[i][j];
+
+					p[strip + 6] = pipeline.x_mesh[i][j + 1];
+					p[strip + 7] = pipeline.y_mesh[i][j + 1];
+				}
 			}
-		}
+		});
 	}
 	else
 	{
 		mesh.Reset();
 		Pipeline *cp = currentPipe;
-		omptl::transform(mesh.p.begin(), mesh.p.end(), mesh.identity.begin(), mesh.p.begin(),
-			[cp](PixelPoint p, PerPixelContext &context) {
-				return cp->PerPixel(p, context);
-			});
-
-		for (int j = 0; j < mesh.height - 1; j++)
+		WorkerPool::shared().parallel_for(mesh.height, [this, cp](int j_begin, int j_end, int thread)
 		{
-			int base = j * mesh.width * 2 * 4;
+			for (int index = j_begin * mesh.width; index < j_end * mesh.width; index++)
+				mesh.p[index] = cp->PerPixel(mesh.p[index], mesh.identity[index]);
+		});
 
-			for (int i = 0; i < mesh.width; i++)
+		WorkerPool::shared().parallel_for(mesh.height - 1, [this](int j_begin, int j_end, int thread)
+		{
+			for (int j = j_begin; j < j_end; j++)
 			{
-				int strip = base + i * 8;
-				int index = j * mesh.width + i;
-				int index2 = (j + 1) * mesh.width + i;
+				int base = j * mesh.width * 2 * 4;
 
-				p[strip + 2] = mesh.p[index].x;
-				p[strip + 3] = mesh.p[index].y;
+				for (int i = 0; i < mesh.width; i++)
+				{
+					int strip = base + i * 8;
+					int index = j * mesh.width + i;
+					int index2 = (j + 1) * mesh.width + i;
 
-				p[strip + 6] = mesh.p[index2].x;
-				p[strip + 7] = mesh.p[index2].y;
+					p[strip + 2] = mesh.p[index].x;
+					p[strip + 3] = mesh.p[index].y;
+
+					p[strip + 6] = mesh.p[index2].x;
+					p[strip + 7] = mesh.p[index2].y;
+				}
 			}
-		}
+		});
 	}
 
 	glBindBuffer(GL_ARRAY_BUFFER, m_vbo_Interpolation);
@@ -0,0 +1,248 @@
+//
+// Cache of preset shader programs, see ShaderCache.hpp
+//
+
+#include "ShaderCache.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#define mkdir(path, mode) _mkdir(path)
+#endif
+
+ShaderCache::ShaderCache(size_t capacity_) : capacity(std::max<size_t>(2, capacity_)), binaries(false)
+{
+    directory = cacheDirectory();
+
+    const char *strings[] = {
+        (const char *)glGetString(GL_VENDOR),
+        (const char *)glGetString(GL_RENDERER),
+        (const char *)glGetString(GL_VERSION)
+    };
+    for (size_t i = 0; i < sizeof(strings) / sizeof(strings[0]); i++)
+    {
+        driver += strings[i] != NULL ? strings[i] : "unknown";
+        driver += '\n';
+    }
+
+#ifdef GL_PROGRAM_BINARY_LENGTH
+    // core since GL 4.1 and GLES 3.0, otherwise GL_ARB_get_program_binary.
+    // without either the query fails and leaves formats at 0
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    glGetError();
+    binaries = formats > 0 && !directory.empty();
+#if defined(_WIN32) && !defined(EYETUNE_WINRT)
+    binaries = binaries && glGetProgramBinary != NULL && glProgramBinary != NULL;
+#endif
+#endif
+}
+
+ShaderCache::~ShaderCache()
+{
+    for (ProgramList::iterator it = programs.begin(); it != programs.end(); ++it)
+        glDeleteProgram(it->second);
+}
+
+std::string ShaderCache::hash(const std::string &source)
+{
+    uint64_t value = 14695981039346656037ULL;
+    for (size_t i = 0; i < source.size(); i++)
+    {
+        value ^= (unsigned char)source[i];
+        value *= 1099511628211ULL;
+    }
+
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)value);
+    return hex;
+}
+
+GLuint ShaderCache::findProgram(const std::string &key)
+{
+    std::map<std::string, ProgramList::iterator>::iterator it = index.find(key);
+    if (it == index.end())
+        return GL_FALSE;
+
+    programs.splice(programs.begin(), programs, it->second);
+    return it->second->second;
+}
+
+void ShaderCache::insertProgram(const std::string &key, GLuint program)
+{
+    std::map<std::string, ProgramList::iterator>::iterator it = index.find(key);
+    if (it != index.end())
+    {
+        if (it->second->second != program)
+            glDeleteProgram(it->second->second);
+        programs.erase(it->second);
+        index.erase(it);
+    }
+
+    programs.push_front(std::make_pair(key, program));
+    index[key] = programs.begin();
+
+    while (programs.size() > capacity)
+    {
+        glDeleteProgram(programs.back().second);
+        index.erase(programs.back().first);
+        programs.pop_back();
+    }
+}
+
+bool ShaderCache::readSource(const std::string &key, std::string &source)
+{
+    if (directory.empty())
+        return false;
+
+    std::ifstream file(path(key, ".glsl").c_str(), std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    source.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad() && !source.empty();
+}
+
+void ShaderCache::writeSource(const std::string &key, const std::string &source)
+{
+    if (!directory.empty())
+        writeFile(path(key, ".glsl"), source);
+}
+
+GLuint ShaderCache::readBinary(const std::string &key)
+{
+#ifdef GL_PROGRAM_BINARY_LENGTH
+    if (!binaries)
+        return GL_FALSE;
+
+    const std::string filename = path(key, ".bin");
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return GL_FALSE;
+
+    const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+
+    // binaries of another driver or GPU are just ignored, they are replaced once the program is linked again
+    const size_t offset = driver.size() + sizeof(GLenum);
+    if (data.size() <= offset || data.compare(0, driver.size(), driver) != 0)
+        return GL_FALSE;
+
+    GLenum format;
+    std::memcpy(&format, data.data() + driver.size(), sizeof(format));
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, format, data.data() + offset, (GLsizei)(data.size() - offset));
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE)
+    {
+        // drivers may reject their own binaries after an update
+        glGetError();
+        glDeleteProgram(program);
+        std::remove(filename.c_str());
+        return GL_FALSE;
+    }
+
+    return program;
+#else
+    return GL_FALSE;
+#endif
+}
+
+void ShaderCache::writeBinary(const std::string &key, GLuint program)
+{
+#ifdef GL_PROGRAM_BINARY_LENGTH
+    if (!binaries)
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    const size_t offset = driver.size() + sizeof(GLenum);
+    std::string data(driver);
+    data.resize(offset + length);
+
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, &data[offset]);
+    if (written <= 0)
+        return;
+
+    std::memcpy(&data[driver.size()], &format, sizeof(format));
+    data.resize(offset + written);
+    writeFile(path(key, ".bin"), data);
+#endif
+}
+
+std::string ShaderCache::path(const std::string &key, const char *extension) const
+{
+    return directory + "/" + key + extension;
+}
+
+bool ShaderCache::writeFile(const std::string &filename, const std::string &data) const
+{
+    // other instances may read the cache at the same time, so files only appear once complete
+    const std::string temporary = filename + ".tmp";
+    {
+        std::ofstream file(temporary.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+        file.write(data.data(), data.size());
+        if (!file.good())
+        {
+            file.close();
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0)
+    {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string ShaderCache::cacheDirectory()
+{
+    std::string base;
+    const char *env;
+#if defined(_WIN32)
+    if ((env = getenv("LOCALAPPDATA")) != NULL)
+        base = env;
+#elif defined(__APPLE__)
+    if ((env = getenv("HOME")) != NULL)
+        base = std::string(env) + "/Library/Caches";
+#else
+    if ((env = getenv("XDG_CACHE_HOME")) != NULL && env[0] != '\0')
+        base = env;
+    else if ((env = getenv("HOME")) != NULL)
+        base = std::string(env) + "/.cache";
+#endif
+    if (base.empty())
+        return std::string();
+
+    const char *subdirs[] = { "", "/projectM", "/projectM/shaders" };
+    for (size_t i = 0; i < sizeof(subdirs) / sizeof(subdirs[0]); i++)
+        mkdir((base + subdirs[i]).c_str(), 0755);
+
+    const std::string directory = base + "/projectM/shaders";
+    struct stat info;
+    if (stat(directory.c_str(), &info) != 0 || (info.st_mode & S_IFDIR) == 0)
+        return std::string();
+
+    return directory;
+}
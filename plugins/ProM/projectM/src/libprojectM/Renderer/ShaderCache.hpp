@@ -0,0 +1,65 @@
+//
+// Cache of preset shader programs, see ShaderEngine::compilePresetShader()
+//
+// Programs are looked up by a hash of everything their code is generated from.
+// Linked programs are kept in memory for the most recently used presets, and the
+// generated GLSL, as well as program binaries when the driver can export them,
+// are stored on disk so that the HLSL translation is only done once per shader.
+//
+
+#ifndef PROJECTM_SHADERCACHE_HPP
+#define PROJECTM_SHADERCACHE_HPP
+
+#include "projectM-opengl.h"
+
+#include <list>
+#include <map>
+#include <string>
+
+class ShaderCache
+{
+public:
+    // expects a current GL context, capacity is the number of linked programs kept in memory
+    explicit ShaderCache(size_t capacity = 16);
+    ~ShaderCache();
+
+    // hex string of the 64 bit FNV-1a hash of source, used as key and file name
+    static std::string hash(const std::string &source);
+
+    // linked program for key or GL_FALSE, the program stays owned by the cache
+    GLuint findProgram(const std::string &key);
+
+    // takes ownership of program and deletes the least recently used ones above capacity,
+    // the two most recent programs (the warp and composite shaders of a preset) are never deleted
+    void insertProgram(const std::string &key, GLuint program);
+
+    // generated GLSL stored on disk
+    bool readSource(const std::string &key, std::string &source);
+    void writeSource(const std::string &key, const std::string &source);
+
+    // program binaries stored on disk, only loaded with the driver that saved them
+    bool binariesSupported() const { return binaries; }
+    GLuint readBinary(const std::string &key);
+    void writeBinary(const std::string &key, GLuint program);
+
+private:
+    typedef std::list<std::pair<std::string, GLuint> > ProgramList;
+
+    size_t capacity;
+    // most recently used first
+    ProgramList programs;
+    std::map<std::string, ProgramList::iterator> index;
+
+    // empty if the cache directory could not be created
+    std::string directory;
+    // identifies the driver in binary files
+    std::string driver;
+    bool binaries;
+
+    std::string path(const std::string &key, const char *extension) const;
+    bool writeFile(const std::string &filename, const std::string &data) const;
+
+    static std::string cacheDirectory();
+};
+
+#endif //PROJECTM_SHADERCACHE_HPP
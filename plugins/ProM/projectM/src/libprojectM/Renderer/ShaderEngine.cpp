@@ -303,6 +303,74 @@ GLuint ShaderEngine::compilePresetShader(const PresentShaderType shaderType, Sha
     default:    shaderTypeString = "Other";
     }
 
+    const std::string vertexSource = shaderType == PresentWarpShader
+        ? StaticGlShaders::Get()->GetPresetWarpVertexShader()
+        : StaticGlShaders::Get()->GetPresetCompVertexShader();
+
+    // everything the program is generated from, samplers are declared according to the texture types
+    std::ostringstream cacheSource;
+    cacheSource << shaderTypeString << "\n"
+                << StaticGlShaders::Get()->GetGlslGeneratorVersion() << "\n"
+                << vertexSource << "\n";
+    std::map<std::string, TextureSamplerDesc>::const_iterator iter_cache = pmShader.textures.cbegin();
+    for ( ; iter_cache != pmShader.textures.cend(); ++iter_cache)
+    {
+        const Texture * texture = iter_cache->second.first;
+        cacheSource << iter_cache->first << " " << texture->name << " " << texture->type << "\n";
+    }
+    cacheSource << fullSource;
+    const std::string cacheKey = ShaderCache::hash(cacheSource.str());
+
+    // presets sharing a shader, or switching back and forth, reuse the linked program
+    GLuint ret = shaderCache.findProgram(cacheKey);
+    if (ret != GL_FALSE) {
+        return ret;
+    }
+
+    ret = shaderCache.readBinary(cacheKey);
+    if (ret != GL_FALSE) {
+        shaderCache.insertProgram(cacheKey, ret);
+        return ret;
+    }
+
+    std::string glslSource;
+    if (!shaderCache.readSource(cacheKey, glslSource)) {
+        if (!translatePresetShader(pmShader, shaderFilename, fullSource, shaderTypeString, glslSource)) {
+            return GL_FALSE;
+        }
+        shaderCache.writeSource(cacheKey, glslSource);
+    }
+
+    // now we have GLSL source for the preset shader program (hopefully it's
+    // valid!) copmile the preset shader fragment shader with the standard
+    // vertex shader and cross our fingers
+    ret = CompileShaderProgram(vertexSource, glslSource, shaderTypeString, shaderCache.binariesSupported());
+
+    if (ret != GL_FALSE) {
+#ifdef DEBUG
+        std::cerr << "Successful compilation of " << shaderTypeString << std::endl;
+#endif
+        shaderCache.writeBinary(cacheKey, ret);
+        shaderCache.insertProgram(cacheKey, ret);
+    } else {
+        std::cerr << "Compilation error (step3) of " << shaderTypeString << std::endl;
+
+#if !DUMP_SHADERS_ON_ERROR
+        std::cerr << "Source:" << std::endl << glslSource << std::endl;
+#else
+        std::ofstream out3("/tmp/shader_" + shaderTypeString + "_step3.txt");
+            out3 << glslSource;
+            out3.close();
+#endif
+    }
+
+    return ret;
+}
+
+
+bool ShaderEngine::translatePresetShader(const Shader &pmShader, const std::string &shaderFilename, const std::string &fullSource,
+                                         const std::string &shaderTypeString, std::string &glslSource)
+{
     M4::GLSLGenerator generator;
     M4::Allocator allocator;
 
@@ -321,7 +389,7 @@ GLuint ShaderEngine::compilePresetShader(const PresentShaderType shaderType, Sha
             out << fullSource;
             out.close();
 #endif
-            return GL_FALSE;
+            return false;
     }
 
     // Remove previous shader declarations
@@ -373,7 +441,7 @@ GLuint ShaderEngine::compilePresetShader(const PresentShaderType shaderType, Sha
             out2 << sourcePreprocessed;
             out2.close();
 #endif
-            return GL_FALSE;
+            return false;
     }
 
     // generate GLSL
@@ -388,40 +456,11 @@ GLuint ShaderEngine::compilePresetShader(const PresentShaderType shaderType, Sha
             out2 << sourcePreprocessed;
             out2.close();
 #endif
-        return GL_FALSE;
-    }
-
-    // now we have GLSL source for the preset shader program (hopefully it's
-    // valid!) copmile the preset shader fragment shader with the standard
-    // vertex shader and cross our fingers
-    GLuint ret = 0;
-    if (shaderType == PresentWarpShader) {
-        ret = CompileShaderProgram(
-            StaticGlShaders::Get()->GetPresetWarpVertexShader(),
-            generator.GetResult(), shaderTypeString);
-    } else {
-        ret = CompileShaderProgram(
-            StaticGlShaders::Get()->GetPresetCompVertexShader(),
-            generator.GetResult(), shaderTypeString);
-    }
-
-    if (ret != GL_FALSE) {
-#ifdef DEBUG
-        std::cerr << "Successful compilation of " << shaderTypeString << std::endl;
-#endif
-    } else {
-        std::cerr << "Compilation error (step3) of " << shaderTypeString << std::endl;
-
-#if !DUMP_SHADERS_ON_ERROR
-        std::cerr << "Source:" << std::endl << generator.GetResult() << std::endl;
-#else
-        std::ofstream out3("/tmp/shader_" + shaderTypeString + "_step3.txt");
-            out3 << generator.GetResult();
-            out3.close();
-#endif
+        return false;
     }
 
-    return ret;
+    glslSource = generator.GetResult();
+    return true;
 }
 
 
@@ -823,14 +862,8 @@ GLuint ShaderEngine::loadPresetShader(const ShaderEngine::PresentShaderType shad
     return program;
 }
 
-// deactivate preset shaders
+// deactivate preset shaders, the programs stay in shaderCache
 void ShaderEngine::disablePresetShaders() {
-    if (presetCompShaderLoaded)
-        glDeleteProgram(programID_presetComp);
-
-    if (presetWarpShaderLoaded)
-        glDeleteProgram(programID_presetWarp);
-
     presetCompShaderLoaded = false;
     presetWarpShaderLoaded = false;
 }
@@ -865,7 +898,7 @@ void ShaderEngine::reset()
     while (k < sizeof(xlate)/sizeof(xlate[0]));
 }
 
-GLuint ShaderEngine::CompileShaderProgram(const std::string & VertexShaderCode, const std::string & FragmentShaderCode, const std::string & shaderTypeString){
+GLuint ShaderEngine::CompileShaderProgram(const std::string & VertexShaderCode, const std::string & FragmentShaderCode, const std::string & shaderTypeString, bool retrievableBinary){
 
 #if defined(WIN32) && !defined(EYETUNE_WINRT)
 	GLenum err = glewInit();
@@ -903,6 +936,10 @@ GLuint ShaderEngine::CompileShaderProgram(const std::string & VertexShaderCode,
 
     glAttachShader(programID, VertexShaderID);
     glAttachShader(programID, FragmentShaderID);
+#ifdef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    if (retrievableBinary)
+        glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
     bool linkOK = linkProgram(programID);
 
     glDetachShader(programID, VertexShaderID);
@@ -22,6 +22,7 @@ class ShaderEngine;
 #include <map>
 #include <sstream>
 #include "Shader.hpp"
+#include "ShaderCache.hpp"
 #include <glm/vec3.hpp>
 
 
@@ -45,7 +46,7 @@ public:
     void setParams(const int _texsizeX, const int texsizeY, BeatDetect *beatDetect, TextureManager *_textureManager);
     void reset();
 
-    static GLuint CompileShaderProgram(const std::string & VertexShaderCode, const std::string & FragmentShaderCode, const std::string & shaderTypeString);
+    static GLuint CompileShaderProgram(const std::string & VertexShaderCode, const std::string & FragmentShaderCode, const std::string & shaderTypeString, bool retrievableBinary = false);
     static bool checkCompileStatus(GLuint shader, const std::string & shaderTitle);
     static bool linkProgram(GLuint programID);
 
@@ -103,6 +104,7 @@ private:
     void SetupShaderVariables(GLuint program, const Pipeline &pipeline, const PipelineContext &pipelineContext);
     void SetupTextures(GLuint program, const Shader &shader);
     GLuint compilePresetShader(const ShaderEngine::PresentShaderType shaderType, Shader &shader, const std::string &shaderFilename);
+    bool translatePresetShader(const Shader &shader, const std::string &shaderFilename, const std::string &fullSource, const std::string &shaderTypeString, std::string &glslSource);
 
     void disablePresetShaders();
     GLuint loadPresetShader(const PresentShaderType shaderType, Shader &shader, std::string &shaderFilename);
@@ -116,6 +118,9 @@ private:
 
     bool presetCompShaderLoaded, presetWarpShaderLoaded;
 
+    // owns the preset programs, which are kept around for presets sharing shaders
+    ShaderCache shaderCache;
+
     std::string m_presetName;
 };
 
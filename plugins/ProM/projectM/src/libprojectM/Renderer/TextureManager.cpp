@@ -40,9 +40,20 @@ TextureManager::TextureManager(const std::string _presetsURL, const int texsizeX
     std::vector<std::string> dirsToScan{datadir + "/presets", datadir + "/textures", _presetsURL};
     FileScanner fileScanner = FileScanner(dirsToScan, extensions);
 
-    // scan for textures
+    // scan for textures, only the file names are kept until a preset needs them
     using namespace std::placeholders;
-    fileScanner.scan(std::bind(&TextureManager::loadTexture, this, _1, _2));
+    fileScanner.scan(std::bind(&TextureManager::indexTexture, this, _1, _2));
+
+#if USE_THREADS
+    loaderFinished = false;
+    pthread_mutex_init(&loaderMutex, NULL);
+    pthread_cond_init(&loaderCondition, NULL);
+    if (pthread_create(&loaderThread, NULL, loaderCallback, this) != 0)
+    {
+        std::cerr << "[projectM] failed to allocate the texture loader thread!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+#endif
 
     Preload();
     // if not data directory specified from user code
@@ -153,6 +164,19 @@ TextureManager::TextureManager(const std::string _presetsURL, const int texsizeX
 
 TextureManager::~TextureManager()
 {
+#if USE_THREADS
+    pthread_mutex_lock(&loaderMutex);
+    loaderFinished = true;
+    pthread_cond_signal(&loaderCondition);
+    pthread_mutex_unlock(&loaderMutex);
+    pthread_join(loaderThread, NULL);
+
+    for (auto image : decodedImages)
+        SOIL_free_image_data(image.data);
+
+    pthread_cond_destroy(&loaderCondition);
+    pthread_mutex_destroy(&loaderMutex);
+#endif
     Clear();
 }
 
@@ -207,6 +231,10 @@ void TextureManager::Clear()
         delete(iter->second);
 
     textures.clear();
+#if USE_THREADS
+    // images still being decoded are dropped by uploadLoadedTextures()
+    pendingTextures.clear();
+#endif
 }
 
 
@@ -231,7 +259,7 @@ TextureSamplerDesc TextureManager::getTexture(const std::string fullName, const
     }
 
     ExtractTextureSettings(fileName, wrap_mode, filter_mode, unqualifiedName);
-    if (textures.find(unqualifiedName) == textures.end())
+    if (textures.find(unqualifiedName) == textures.end() && !loadIndexedTexture(unqualifiedName))
     {
         return TextureSamplerDesc(NULL, NULL);
     }
@@ -314,6 +342,112 @@ TextureSamplerDesc TextureManager::loadTexture(const std::string fileName, const
     return TextureSamplerDesc(newTexture, sampler);
 }
 
+void TextureManager::indexTexture(const std::string fileName, const std::string name)
+{
+    // like loading, a later file with the same name replaces the previous one
+    textureFiles[name] = fileName;
+}
+
+bool TextureManager::loadIndexedTexture(const std::string name)
+{
+    std::map<std::string, std::string>::const_iterator file = textureFiles.find(name);
+    if (file == textureFiles.end())
+        return false;
+
+#if USE_THREADS
+    // show a transparent placeholder until the loader thread has decoded the image
+    static const unsigned char placeholder[4] = { 0, 0, 0, 0 };
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLint wrap_mode;
+    GLint filter_mode;
+    std::string unqualifiedName;
+
+    ExtractTextureSettings(name, wrap_mode, filter_mode, unqualifiedName);
+    Texture * newTexture = new Texture(unqualifiedName, tex, GL_TEXTURE_2D, 1, 1, true);
+    textures[name] = newTexture;
+    pendingTextures[name] = newTexture;
+
+    pthread_mutex_lock(&loaderMutex);
+    loadRequests.push_back(std::make_pair(name, file->second));
+    pthread_cond_signal(&loaderCondition);
+    pthread_mutex_unlock(&loaderMutex);
+    return true;
+#else
+    return loadTexture(file->second, name).first != NULL;
+#endif
+}
+
+void TextureManager::uploadLoadedTextures()
+{
+#if USE_THREADS
+    std::vector<DecodedImage> images;
+
+    pthread_mutex_lock(&loaderMutex);
+    images.swap(decodedImages);
+    pthread_mutex_unlock(&loaderMutex);
+
+    for (auto image : images)
+    {
+        std::map<std::string, Texture*>::iterator pending = pendingTextures.find(image.name);
+        if (pending != pendingTextures.end())
+        {
+            Texture * texture = pending->second;
+            pendingTextures.erase(pending);
+
+            int width = image.width;
+            int height = image.height;
+            if (image.data != NULL &&
+                SOIL_create_OGL_texture(image.data, &width, &height, image.channels, texture->texID, SOIL_FLAG_MULTIPLY_ALPHA) != 0)
+            {
+                texture->width = width;
+                texture->height = height;
+            }
+            else
+            {
+                std::cerr << "Failed to load texture " << image.name << std::endl;
+            }
+        }
+
+        SOIL_free_image_data(image.data);
+    }
+#endif
+}
+
+#if USE_THREADS
+void *TextureManager::loaderCallback(void *arg)
+{
+    TextureManager *manager = (TextureManager *)arg;
+
+    pthread_mutex_lock(&manager->loaderMutex);
+    for (;;)
+    {
+        while (manager->loadRequests.empty() && !manager->loaderFinished)
+            pthread_cond_wait(&manager->loaderCondition, &manager->loaderMutex);
+        if (manager->loaderFinished)
+            break;
+
+        std::pair<std::string, std::string> request = manager->loadRequests.front();
+        manager->loadRequests.pop_front();
+        pthread_mutex_unlock(&manager->loaderMutex);
+
+        DecodedImage image;
+        image.name = request.first;
+        image.data = SOIL_load_image(request.second.c_str(), &image.width, &image.height, &image.channels, SOIL_LOAD_AUTO);
+
+        pthread_mutex_lock(&manager->loaderMutex);
+        manager->decodedImages.push_back(image);
+    }
+    pthread_mutex_unlock(&manager->loaderMutex);
+
+    return NULL;
+}
+#endif
+
 TextureSamplerDesc TextureManager::getRandomTextureName(std::string random_id)
 {
     GLint wrap_mode;
@@ -340,9 +474,25 @@ TextureSamplerDesc TextureManager::getRandomTextureName(std::string random_id)
         }
     }
 
+    for(std::map<std::string, std::string>::const_iterator iter = textureFiles.begin(); iter != textureFiles.end(); iter++)
+    {
+        if (textures.find(iter->first) == textures.end()) {
+            if (textureNameFilter.empty() || iter->first.find(textureNameFilter) == 0)
+                user_texture_names.push_back(iter->first);
+        }
+    }
+
     if (user_texture_names.size() > 0)
     {
         std::string random_name = user_texture_names[rand() % user_texture_names.size()];
+
+        // the copy below shares the texture, so decode it right away instead of showing the placeholder
+        if (textures.find(random_name) == textures.end() &&
+            loadTexture(textureFiles[random_name], random_name).first == NULL)
+        {
+            return TextureSamplerDesc(NULL, NULL);
+        }
+
         random_textures.push_back(random_id);
 
         Texture * randomTexture = new Texture(*textures[random_name]);
@@ -1,14 +1,20 @@
 #ifndef TextureManager_HPP
 #define TextureManager_HPP
 
+#include "config.h"
 #include <iostream>
 #include <string>
+#include <deque>
 #include <map>
 #include <vector>
 #include "projectM-opengl.h"
 #include "Texture.hpp"
 #include "FileScanner.hpp"
 
+#if USE_THREADS
+#include <pthread.h>
+#endif
+
 
 class TextureManager
 {
@@ -22,6 +28,35 @@ class TextureManager
   void ExtractTextureSettings(const std::string qualifiedName, GLint &_wrap_mode, GLint &_filter_mode, std::string & name);
   std::vector<std::string> extensions;
 
+  // image files found when scanning, by texture name. They are only decoded once a preset uses them
+  std::map<std::string, std::string> textureFiles;
+  void indexTexture(const std::string fileName, const std::string name);
+  bool loadIndexedTexture(const std::string name);
+
+#if USE_THREADS
+  struct DecodedImage
+  {
+    std::string name;
+    unsigned char *data;
+    int width;
+    int height;
+    int channels;
+  };
+
+  // textures showing a placeholder until their image is decoded, by name
+  std::map<std::string, Texture*> pendingTextures;
+
+  pthread_t loaderThread;
+  pthread_mutex_t loaderMutex;
+  pthread_cond_t loaderCondition;
+  // guarded by loaderMutex
+  std::deque<std::pair<std::string, std::string> > loadRequests;
+  std::vector<DecodedImage> decodedImages;
+  bool loaderFinished;
+
+  static void *loaderCallback(void *arg);
+#endif
+
 public:
   TextureManager(std::string _presetsURL, const int texsizeX, const int texsizeY,
                  std::string datadir = "");
@@ -35,6 +70,8 @@ public:
   const std::vector<Texture *> & getBlurTextures() const;
 
   void updateMainTexture();
+  // uploads textures decoded in the background, called once per frame
+  void uploadLoadedTextures();
 
   TextureSamplerDesc getRandomTextureName(std::string rand_name);
   void clearRandomTextures();
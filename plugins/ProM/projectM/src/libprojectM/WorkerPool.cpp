@@ -0,0 +1,145 @@
+//
+// Small persistent thread pool to split mesh loops into tiles of rows
+//
+
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+#if USE_THREADS
+
+WorkerPool::WorkerPool(int num_threads_) : num_threads(std::max(1, num_threads_)),
+    task(nullptr), task_count(0), tile_size(1), generation(0), running(0), finished(false), next_tile(0)
+{
+    pthread_mutex_init(&busy, NULL);
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&condition_start_work, NULL);
+    pthread_cond_init(&condition_work_done, NULL);
+
+    // the calling thread is thread 0, workers must not move once started
+    workers.resize(num_threads - 1);
+    for (int i = 0; i < num_threads - 1; i++)
+    {
+        workers[i].pool = this;
+        workers[i].index = i + 1;
+        if (pthread_create(&workers[i].thread, NULL, thread_callback, &workers[i]) != 0)
+        {
+            std::cerr << "[projectM] failed to allocate a worker thread, using " << i + 1 << " threads" << std::endl;
+            workers.resize(i);
+            num_threads = i + 1;
+            break;
+        }
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    pthread_mutex_lock(&mutex);
+    finished = true;
+    pthread_cond_broadcast(&condition_start_work);
+    pthread_mutex_unlock(&mutex);
+
+    for (size_t i = 0; i < workers.size(); i++)
+        pthread_join(workers[i].thread, NULL);
+
+    pthread_cond_destroy(&condition_work_done);
+    pthread_cond_destroy(&condition_start_work);
+    pthread_mutex_destroy(&mutex);
+    pthread_mutex_destroy(&busy);
+}
+
+void WorkerPool::parallel_for(int count, const Task &task_)
+{
+    if (count <= 0)
+        return;
+
+    if (num_threads == 1 || count == 1 || pthread_mutex_trylock(&busy) != 0)
+    {
+        task_(0, count, 0);
+        return;
+    }
+
+    pthread_mutex_lock(&mutex);
+    task = &task_;
+    task_count = count;
+    // a few tiles per thread, so that a slow tile does not hold up the others
+    tile_size = std::max(1, count / (num_threads * 4));
+    next_tile = 0;
+    running = num_threads - 1;
+    generation++;
+    pthread_cond_broadcast(&condition_start_work);
+    pthread_mutex_unlock(&mutex);
+
+    work(0);
+
+    pthread_mutex_lock(&mutex);
+    while (running > 0)
+        pthread_cond_wait(&condition_work_done, &mutex);
+    task = nullptr;
+    pthread_mutex_unlock(&mutex);
+
+    pthread_mutex_unlock(&busy);
+}
+
+void WorkerPool::work(int thread)
+{
+    for (;;)
+    {
+        const int begin = next_tile.fetch_add(tile_size);
+        if (begin >= task_count)
+            break;
+        (*task)(begin, std::min(begin + tile_size, task_count), thread);
+    }
+}
+
+void *WorkerPool::thread_callback(void *arg)
+{
+    Worker *worker = (Worker *)arg;
+    WorkerPool *pool = worker->pool;
+    unsigned seen = 0;
+
+    pthread_mutex_lock(&pool->mutex);
+    for (;;)
+    {
+        while (pool->generation == seen && !pool->finished)
+            pthread_cond_wait(&pool->condition_start_work, &pool->mutex);
+        if (pool->finished)
+            break;
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->mutex);
+
+        pool->work(worker->index);
+
+        pthread_mutex_lock(&pool->mutex);
+        if (--pool->running == 0)
+            pthread_cond_signal(&pool->condition_work_done);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+#else
+
+WorkerPool::WorkerPool(int num_threads_) : num_threads(1)
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+}
+
+void WorkerPool::parallel_for(int count, const Task &task)
+{
+    if (count > 0)
+        task(0, count, 0);
+}
+
+#endif
+
+WorkerPool &WorkerPool::shared()
+{
+    static WorkerPool pool(std::thread::hardware_concurrency());
+    return pool;
+}
@@ -0,0 +1,70 @@
+//
+// Small persistent thread pool to split mesh loops into tiles of rows
+// see MilkdropPreset::evalPerPixelEqns(), PresetOutputs::PerPixelMath() and Renderer::Interpolation()
+//
+
+#ifndef PROJECTM_WORKERPOOL_HPP
+#define PROJECTM_WORKERPOOL_HPP
+
+#include "config.h"
+#include <functional>
+#include <vector>
+
+#if USE_THREADS
+#include <atomic>
+#include <pthread.h>
+#endif
+
+class WorkerPool
+{
+public:
+    // called with tiles [begin, end) of the range, thread is below size() and unique among concurrent calls
+    typedef std::function<void(int begin, int end, int thread)> Task;
+
+    explicit WorkerPool(int num_threads);
+    ~WorkerPool();
+
+    // number of threads working on a task, including the calling one
+    int size() const { return num_threads; }
+
+    // runs task over [0, count) and returns when all tiles are done.
+    // if another thread is using the pool, the whole range runs on the calling thread
+    void parallel_for(int count, const Task &task);
+
+    // pool shared by all projectM instances, with one thread per core
+    static WorkerPool &shared();
+
+private:
+    int num_threads;
+
+#if USE_THREADS
+    struct Worker
+    {
+        WorkerPool *pool;
+        int index;
+        pthread_t thread;
+    };
+
+    std::vector<Worker> workers;
+    pthread_mutex_t busy;
+    pthread_mutex_t mutex;
+    pthread_cond_t  condition_start_work;
+    pthread_cond_t  condition_work_done;
+
+    // guarded by mutex
+    const Task *task;
+    int task_count;
+    int tile_size;
+    unsigned generation;
+    int running;
+    bool finished;
+
+    std::atomic<int> next_tile;
+
+    static void *thread_callback(void *arg);
+    void work(int thread);
+#endif
+};
+
+
+#endif //PROJECTM_WORKERPOOL_HPP
@@ -16,6 +16,8 @@
 
 #include "DistrhoPluginMaxGen.hpp"
 
+#include <vector>
+
 #include "gen_exported.cpp"
 
 namespace gen = gen_exported;
@@ -82,6 +84,22 @@ void DistrhoPluginMaxGen::run(const float** inputs, float** outputs, uint32_t fr
     gen::perform(fGenState, (float**)inputs, gen::gen_kernel_numins, outputs, gen::gen_kernel_numouts, frames);
 }
 
+void DistrhoPluginMaxGen::sampleRateChanged(double newSampleRate)
+{
+    // gen::reset() also restores the default parameter values, keep the current ones
+    const int numParams = gen::num_params();
+    std::vector<t_param> values(numParams);
+
+    for (int i=0; i < numParams; ++i)
+        gen::getparameter(fGenState, i, &values[i]);
+
+    fGenState->sr = newSampleRate;
+    gen::reset(fGenState);
+
+    for (int i=0; i < numParams; ++i)
+        gen::setparameter(fGenState, i, values[i], nullptr);
+}
+
 // -----------------------------------------------------------------------
 
 Plugin* createPlugin()
@@ -85,6 +85,7 @@ protected:
     // Process
 
     void run(const float** inputs, float** outputs, uint32_t frames) override;
+    void sampleRateChanged(double newSampleRate) override;
 
     // -------------------------------------------------------------------
 
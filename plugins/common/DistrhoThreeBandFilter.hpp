@@ -0,0 +1,495 @@
+/*
+ * DISTRHO Plugins, shared filter kernels for 3BandEQ and 3BandSplitter
+ * Copyright (C) 2007 Michael Gruhn <michael-gruhn@web.de>
+ * Copyright (C) 2012-2022 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * For a full copy of the license see the LICENSE file.
+ */
+
+#ifndef DISTRHO_THREE_BAND_FILTER_HPP_INCLUDED
+#define DISTRHO_THREE_BAND_FILTER_HPP_INCLUDED
+
+#include "DistrhoUtils.hpp"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define DISTRHO_THREE_BAND_FILTER_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+# include <arm_neon.h>
+# define DISTRHO_THREE_BAND_FILTER_NEON
+#endif
+
+#ifdef __SSE2_MATH__
+# include <xmmintrin.h>
+#endif
+
+START_NAMESPACE_DISTRHO
+
+// -----------------------------------------------------------------------
+
+/**
+   Enables flush-to-zero and denormals-are-zero for the current thread, restoring the previous mode when going out of scope.
+   Meant to be placed at the start of run(), replacing per-sample tricks like adding a tiny DC offset.
+   Does nothing on platforms without such a mode, see ThreeBandFilter::process() for how the filters cope with that.
+ */
+class ScopedDenormalDisable
+{
+public:
+#if defined(__SSE2_MATH__)
+    ScopedDenormalDisable() noexcept
+        : fPrevious(_mm_getcsr())
+    {
+        _mm_setcsr(fPrevious | 0x8040);
+    }
+
+    ~ScopedDenormalDisable() noexcept
+    {
+        _mm_setcsr(fPrevious);
+    }
+
+    static constexpr const bool kAvailable = true;
+
+private:
+    const unsigned int fPrevious;
+#elif defined(__aarch64__)
+    ScopedDenormalDisable() noexcept
+    {
+        uint64_t fpcr;
+        __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+        fPrevious = fpcr;
+        __asm__ __volatile__("msr fpcr, %0" :: "r"(fpcr | (1ULL << 24)));
+    }
+
+    ~ScopedDenormalDisable() noexcept
+    {
+        __asm__ __volatile__("msr fpcr, %0" :: "r"(fPrevious));
+    }
+
+    static constexpr const bool kAvailable = true;
+
+private:
+    uint64_t fPrevious;
+#elif defined(__arm__) && defined(__ARM_PCS_VFP)
+    ScopedDenormalDisable() noexcept
+    {
+        uint32_t fpscr;
+        __asm__ __volatile__("vmrs %0, fpscr" : "=r"(fpscr));
+        fPrevious = fpscr;
+        __asm__ __volatile__("vmsr fpscr, %0" :: "r"(fpscr | (1U << 24)));
+    }
+
+    ~ScopedDenormalDisable() noexcept
+    {
+        __asm__ __volatile__("vmsr fpscr, %0" :: "r"(fPrevious));
+    }
+
+    static constexpr const bool kAvailable = true;
+
+private:
+    uint32_t fPrevious;
+#else
+    ScopedDenormalDisable() noexcept {}
+
+    static constexpr const bool kAvailable = false;
+#endif
+
+    DISTRHO_DECLARE_NON_COPYABLE(ScopedDenormalDisable)
+    DISTRHO_PREVENT_HEAP_ALLOCATION
+};
+
+// -----------------------------------------------------------------------
+
+/**
+   The pair of one-pole filters of Michael Gruhn's 3 Band EQ, for any number of channels.
+
+   Channels are processed in pairs, the low-pass and high-pass states of a pair being the 4 lanes of one SIMD register,
+   so that each sample frame of a stereo signal is a single multiply-subtract.
+   Uses SSE2 or NEON when available, otherwise plain scalar code.
+
+   The mid band is not computed, it is simply input - low - high.
+ */
+template<uint32_t kChannels>
+class ThreeBandFilter
+{
+public:
+    ThreeBandFilter() noexcept
+    {
+        setCoefficients(0.0f, 0.0f, 0.0f, 0.0f);
+        reset();
+    }
+
+    /**
+       Set the coefficients of the low/mid and mid/high crossovers, y = a0 * x - b1 * y.
+     */
+    void setCoefficients(const float a0LP, const float b1LP, const float a0HP, const float b1HP) noexcept
+    {
+        fA0[0] = fA0[1] = a0LP;
+        fA0[2] = fA0[3] = a0HP;
+        fB1[0] = fB1[1] = b1LP;
+        fB1[2] = fB1[3] = b1HP;
+    }
+
+    /**
+       Clear the filter state.
+     */
+    void reset() noexcept
+    {
+        std::memset(fState, 0, sizeof(fState));
+    }
+
+    /**
+       Split @a frames of every input channel into its low and high bands.
+       Output buffers must not overlap the inputs.
+       Expects flush-to-zero to be enabled by the caller, see ScopedDenormalDisable.
+     */
+    void process(const float* const* const inputs, float* const* const low, float* const* const high, const uint32_t frames) noexcept
+    {
+        for (uint32_t c = 0; c < kChannels; c += 2)
+        {
+            // an odd channel count filters the last channel twice, writing it only once
+            const uint32_t c2 = c + 1 < kChannels ? c + 1 : c;
+            float* const state = fState[c / 2];
+
+            processPair(state, inputs[c], inputs[c2], low[c], low[c2], high[c], high[c2], frames);
+
+            // without flush-to-zero, a decaying state turns denormal after a few thousand frames of silence,
+            // so clearing it once per block is enough
+            if (! ScopedDenormalDisable::kAvailable)
+            {
+                for (int i = 0; i < 4; ++i)
+                    if (std::fabs(state[i]) < 1e-20f)
+                        state[i] = 0.0f;
+            }
+        }
+    }
+
+private:
+    alignas(16) float fA0[4];
+    alignas(16) float fB1[4];
+
+    // lanes are low-pass left, low-pass right, high-pass left, high-pass right
+    alignas(16) float fState[(kChannels + 1) / 2][4];
+
+    void processPair(float* const state, const float* const inL, const float* const inR,
+                     float* const lowL, float* const lowR, float* const highL, float* const highR,
+                     const uint32_t frames) const noexcept
+    {
+        uint32_t i = 0;
+
+#if defined(DISTRHO_THREE_BAND_FILTER_SSE2)
+        const __m128 a0 = _mm_load_ps(fA0);
+        const __m128 b1 = _mm_load_ps(fB1);
+        __m128 s = _mm_load_ps(state);
+
+        // 4 frames at a time, transposing from planar channels to one register per frame and back
+        for (; i + 4 <= frames; i += 4)
+        {
+            const __m128 l = _mm_loadu_ps(inL + i);
+            const __m128 r = _mm_loadu_ps(inR + i);
+            const __m128 lr01 = _mm_unpacklo_ps(l, r);
+            const __m128 lr23 = _mm_unpackhi_ps(l, r);
+
+            __m128 s0, s1, s2, s3;
+            s = s0 = _mm_sub_ps(_mm_mul_ps(a0, _mm_movelh_ps(lr01, lr01)), _mm_mul_ps(b1, s));
+            s = s1 = _mm_sub_ps(_mm_mul_ps(a0, _mm_movehl_ps(lr01, lr01)), _mm_mul_ps(b1, s));
+            s = s2 = _mm_sub_ps(_mm_mul_ps(a0, _mm_movelh_ps(lr23, lr23)), _mm_mul_ps(b1, s));
+            s = s3 = _mm_sub_ps(_mm_mul_ps(a0, _mm_movehl_ps(lr23, lr23)), _mm_mul_ps(b1, s));
+
+            _MM_TRANSPOSE4_PS(s0, s1, s2, s3);
+
+            _mm_storeu_ps(lowL + i, s0);
+            _mm_storeu_ps(lowR + i, s1);
+            _mm_storeu_ps(highL + i, _mm_sub_ps(l, s2));
+            _mm_storeu_ps(highR + i, _mm_sub_ps(r, s3));
+        }
+
+        for (; i < frames; ++i)
+        {
+            const float l = inL[i];
+            const float r = inR[i];
+            alignas(16) float out[4];
+
+            s = _mm_sub_ps(_mm_mul_ps(a0, _mm_setr_ps(l, r, l, r)), _mm_mul_ps(b1, s));
+            _mm_store_ps(out, s);
+
+            lowL[i]  = out[0];
+            lowR[i]  = out[1];
+            highL[i] = l - out[2];
+            highR[i] = r - out[3];
+        }
+
+        _mm_store_ps(state, s);
+#elif defined(DISTRHO_THREE_BAND_FILTER_NEON)
+        const float32x4_t a0 = vld1q_f32(fA0);
+        const float32x4_t b1 = vld1q_f32(fB1);
+        float32x4_t s = vld1q_f32(state);
+
+        // 4 frames at a time, transposing from planar channels to one register per frame and back
+        for (; i + 4 <= frames; i += 4)
+        {
+            const float32x4_t l = vld1q_f32(inL + i);
+            const float32x4_t r = vld1q_f32(inR + i);
+            const float32x4x2_t lr = vzipq_f32(l, r);
+
+            float32x4_t s0, s1, s2, s3;
+            s = s0 = vmlsq_f32(vmulq_f32(a0, vcombine_f32(vget_low_f32(lr.val[0]), vget_low_f32(lr.val[0]))), b1, s);
+            s = s1 = vmlsq_f32(vmulq_f32(a0, vcombine_f32(vget_high_f32(lr.val[0]), vget_high_f32(lr.val[0]))), b1, s);
+            s = s2 = vmlsq_f32(vmulq_f32(a0, vcombine_f32(vget_low_f32(lr.val[1]), vget_low_f32(lr.val[1]))), b1, s);
+            s = s3 = vmlsq_f32(vmulq_f32(a0, vcombine_f32(vget_high_f32(lr.val[1]), vget_high_f32(lr.val[1]))), b1, s);
+
+            const float32x4x2_t t01 = vtrnq_f32(s0, s1);
+            const float32x4x2_t t23 = vtrnq_f32(s2, s3);
+
+            vst1q_f32(lowL + i, vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0])));
+            vst1q_f32(lowR + i, vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1])));
+            vst1q_f32(highL + i, vsubq_f32(l, vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]))));
+            vst1q_f32(highR + i, vsubq_f32(r, vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]))));
+        }
+
+        for (; i < frames; ++i)
+        {
+            const float l = inL[i];
+            const float r = inR[i];
+            const float32x4_t x = vcombine_f32(vset_lane_f32(r, vdup_n_f32(l), 1), vset_lane_f32(r, vdup_n_f32(l), 1));
+            float out[4];
+
+            s = vmlsq_f32(vmulq_f32(a0, x), b1, s);
+            vst1q_f32(out, s);
+
+            lowL[i]  = out[0];
+            lowR[i]  = out[1];
+            highL[i] = l - out[2];
+            highR[i] = r - out[3];
+        }
+
+        vst1q_f32(state, s);
+#else
+        float s0 = state[0], s1 = state[1], s2 = state[2], s3 = state[3];
+
+        for (; i < frames; ++i)
+        {
+            const float l = inL[i];
+            const float r = inR[i];
+
+            s0 = fA0[0] * l - fB1[0] * s0;
+            s1 = fA0[1] * r - fB1[1] * s1;
+            s2 = fA0[2] * l - fB1[2] * s2;
+            s3 = fA0[3] * r - fB1[3] * s3;
+
+            lowL[i]  = s0;
+            lowR[i]  = s1;
+            highL[i] = l - s2;
+            highR[i] = r - s3;
+        }
+
+        state[0] = s0;
+        state[1] = s1;
+        state[2] = s2;
+        state[3] = s3;
+#endif
+    }
+
+    DISTRHO_DECLARE_NON_COPYABLE(ThreeBandFilter)
+};
+
+// -----------------------------------------------------------------------
+
+/**
+   A 3 band Linkwitz-Riley crossover with 24 dB/oct slopes, for any number of channels.
+
+   Each 4th order filter is a pair of 2nd order Butterworth sections, as biquads in transposed direct form II.
+   The low band also goes through an allpass at the mid/high frequency, so that the bands sum back to an allpass,
+   meaning low + mid + high has a flat magnitude response.
+
+   Every band of every channel is one lane of a single vector, lanes being band * kChannels + channel.
+   All bands go through the same 4 sections, the ones a band does not need being identity or duplicate ones:
+    - low:  lowpass(f1), lowpass(f1), allpass(f2), identity
+    - mid:  highpass(f1), highpass(f1), lowpass(f2), lowpass(f2)
+    - high: highpass(f1), highpass(f1), highpass(f2), highpass(f2)
+   which keeps the per-frame loops branch-free over a fixed number of lanes, for the compiler to vectorize.
+ */
+template<uint32_t kChannels>
+class LinkwitzRileyCrossover
+{
+public:
+    static constexpr const uint32_t kBands    = 3;
+    static constexpr const uint32_t kSections = 4;
+    static constexpr const uint32_t kLanes    = (kChannels * kBands + 3) & ~3U;
+
+    LinkwitzRileyCrossover() noexcept
+    {
+        setFrequencies(220.0f, 2000.0f, 44100.0);
+        reset();
+    }
+
+    /**
+       Set the low/mid and mid/high crossover frequencies.
+       Frequencies are limited to 10 Hz and 0.45 times the sample rate.
+     */
+    void setFrequencies(const float lowMid, const float midHigh, const double sampleRate) noexcept
+    {
+        if (sampleRate <= 0.0)
+            return;
+
+        const float maxFreq = static_cast<float>(sampleRate * 0.45);
+        const float f1 = std::max(10.0f, std::min(lowMid, maxFreq));
+        const float f2 = std::max(10.0f, std::min(midHigh, maxFreq));
+
+        const Biquad lp1 = Biquad::filter(kLowpass,  f1, sampleRate);
+        const Biquad hp1 = Biquad::filter(kHighpass, f1, sampleRate);
+        const Biquad lp2 = Biquad::filter(kLowpass,  f2, sampleRate);
+        const Biquad hp2 = Biquad::filter(kHighpass, f2, sampleRate);
+        const Biquad ap2 = Biquad::filter(kAllpass,  f2, sampleRate);
+        const Biquad identity = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+
+        const Biquad sections[kBands][kSections] = {
+            { lp1, lp1, ap2, identity },
+            { hp1, hp1, lp2, lp2 },
+            { hp1, hp1, hp2, hp2 },
+        };
+
+        for (uint32_t s = 0; s < kSections; ++s)
+        {
+            for (uint32_t k = 0; k < kLanes; ++k)
+            {
+                // unused lanes only ever see silence
+                const Biquad& c(k < kChannels * kBands ? sections[k / kChannels][s] : identity);
+                fB0[s][k] = c.b0;
+                fB1[s][k] = c.b1;
+                fB2[s][k] = c.b2;
+                fA1[s][k] = c.a1;
+                fA2[s][k] = c.a2;
+            }
+        }
+    }
+
+    /**
+       Clear the filter state.
+     */
+    void reset() noexcept
+    {
+        std::memset(fZ1, 0, sizeof(fZ1));
+        std::memset(fZ2, 0, sizeof(fZ2));
+    }
+
+    /**
+       Split @a frames of every input channel into its low, mid and high bands.
+       Output buffers must not overlap the inputs.
+       Expects flush-to-zero to be enabled by the caller, see ScopedDenormalDisable.
+     */
+    void process(const float* const* const inputs, float* const* const low, float* const* const mid, float* const* const high,
+                 const uint32_t frames) noexcept
+    {
+        alignas(16) float v[kLanes] = {};
+
+        for (uint32_t i = 0; i < frames; ++i)
+        {
+            for (uint32_t b = 0; b < kBands; ++b)
+                for (uint32_t c = 0; c < kChannels; ++c)
+                    v[b * kChannels + c] = inputs[c][i];
+
+            for (uint32_t s = 0; s < kSections; ++s)
+            {
+                for (uint32_t k = 0; k < kLanes; ++k)
+                {
+                    const float x = v[k];
+                    const float y = fB0[s][k] * x + fZ1[s][k];
+                    fZ1[s][k] = fB1[s][k] * x - fA1[s][k] * y + fZ2[s][k];
+                    fZ2[s][k] = fB2[s][k] * x - fA2[s][k] * y;
+                    v[k] = y;
+                }
+            }
+
+            for (uint32_t c = 0; c < kChannels; ++c)
+            {
+                low[c][i]  = v[c];
+                mid[c][i]  = v[kChannels + c];
+                high[c][i] = v[kChannels * 2 + c];
+            }
+        }
+
+        if (! ScopedDenormalDisable::kAvailable)
+        {
+            for (uint32_t s = 0; s < kSections; ++s)
+            {
+                for (uint32_t k = 0; k < kLanes; ++k)
+                {
+                    if (std::fabs(fZ1[s][k]) < 1e-20f)
+                        fZ1[s][k] = 0.0f;
+                    if (std::fabs(fZ2[s][k]) < 1e-20f)
+                        fZ2[s][k] = 0.0f;
+                }
+            }
+        }
+    }
+
+private:
+    enum FilterType { kLowpass, kHighpass, kAllpass };
+
+    struct Biquad {
+        float b0, b1, b2, a1, a2;
+
+        // RBJ cookbook filters with butterworth Q, normalized to a0 = 1
+        static Biquad filter(const FilterType type, const float freq, const double sampleRate) noexcept
+        {
+            const double w0    = 2.0 * M_PI * freq / sampleRate;
+            const double cosw  = std::cos(w0);
+            const double alpha = std::sin(w0) / (2.0 * 0.7071067811865476);
+            const double a0    = 1.0 + alpha;
+
+            double b0, b1, b2;
+            switch (type)
+            {
+            case kLowpass:
+                b0 = b2 = (1.0 - cosw) * 0.5;
+                b1 = 1.0 - cosw;
+                break;
+            case kHighpass:
+                b0 = b2 = (1.0 + cosw) * 0.5;
+                b1 = -(1.0 + cosw);
+                break;
+            default:
+                b0 = 1.0 - alpha;
+                b1 = -2.0 * cosw;
+                b2 = 1.0 + alpha;
+                break;
+            }
+
+            const Biquad c = {
+                static_cast<float>(b0 / a0),
+                static_cast<float>(b1 / a0),
+                static_cast<float>(b2 / a0),
+                static_cast<float>(-2.0 * cosw / a0),
+                static_cast<float>((1.0 - alpha) / a0)
+            };
+            return c;
+        }
+    };
+
+    alignas(16) float fB0[kSections][kLanes];
+    alignas(16) float fB1[kSections][kLanes];
+    alignas(16) float fB2[kSections][kLanes];
+    alignas(16) float fA1[kSections][kLanes];
+    alignas(16) float fA2[kSections][kLanes];
+    alignas(16) float fZ1[kSections][kLanes];
+    alignas(16) float fZ2[kSections][kLanes];
+
+    DISTRHO_DECLARE_NON_COPYABLE(LinkwitzRileyCrossover)
+};
+
+// -----------------------------------------------------------------------
+
+END_NAMESPACE_DISTRHO
+
+#endif // DISTRHO_THREE_BAND_FILTER_HPP_INCLUDED
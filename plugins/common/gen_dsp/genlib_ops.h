@@ -409,6 +409,28 @@ inline t_sample clamp(t_sample x, t_sample minVal, t_sample maxVal) {
 	return minimum(maximum(x,minVal),maxVal); 
 }
 
+// block versions of some stateless operators, for kernels processing vectors of samples
+// (out may be the same buffer as an input):
+inline void safediv_block(const t_sample * num, const t_sample * denom, t_sample * out, long n) {
+	for (long i = 0; i < n; i++) out[i] = denom[i] == t_sample(0) ? t_sample(0) : num[i]/denom[i];
+}
+
+inline void safepow_block(const t_sample * base, const t_sample * exponent, t_sample * out, long n) {
+	for (long i = 0; i < n; i++) out[i] = safepow(base[i], exponent[i]);
+}
+
+inline void fold_block(const t_sample * v, t_sample lo, t_sample hi, t_sample * out, long n) {
+	for (long i = 0; i < n; i++) out[i] = fold(v[i], lo, hi);
+}
+
+inline void wrap_block(const t_sample * v, t_sample lo, t_sample hi, t_sample * out, long n) {
+	for (long i = 0; i < n; i++) out[i] = wrap(v[i], lo, hi);
+}
+
+inline void clamp_block(const t_sample * x, t_sample minVal, t_sample maxVal, t_sample * out, long n) {
+	for (long i = 0; i < n; i++) out[i] = x[i] < minVal ? minVal : (x[i] > maxVal ? maxVal : x[i]);
+}
+
 template<typename T>
 inline T smoothstep(double e0, double e1, T x) {
 	T t = clamp( safediv(x-T(e0),T(e1-e0)), 0., 1. );
@@ -830,6 +852,11 @@ struct Delay {
 				genlib_report_error("failed to acquire data");
 				return; 
 			}
+		}
+		
+		if (memory == 0 || d > maxdelay) {
+			// a reset after a samplerate change may need a longer delay:
+			const bool first = (memory == 0);
 			
 			// scale maxdelay to next highest power of 2:
 			maxdelay = d;
@@ -852,7 +879,13 @@ struct Delay {
 					return;
 				}
 				memory = info.data;
-				writer = genlib_data_getcursor(dataRef);
+				if (first) {
+					writer = genlib_data_getcursor(dataRef);
+				} else {
+					// the resize kept the old contents, clear them like any other reset:
+					set_zero64(memory, size);
+					writer = 0;
+				}
 			} else {
 				genlib_report_error("failed to acquire data info");
 			}
@@ -942,6 +975,59 @@ struct Delay {
 		t_sample z = memory[r4 & wrap];
 		return spline_interp(a, w, x, y, z);
 	}
+	
+	// block variants, equivalent to n reads at a constant delay time followed by n write() & step() pairs.
+	// all reads happen before the block is written, so the delay time must be at least n samples
+	// (n+2 for cubic), otherwise the reads would need samples written within the same block.
+	inline void read_linear_block(t_sample d, t_sample * out, long n) {
+		// min 1 sample delay for read before write (r != w)
+		t_sample c = clamp(d, (reader != writer), maxdelay);
+		const t_sample r = t_sample(size + reader) - c;	
+		long r1 = long(r);
+		t_sample a = r - (t_sample)r1;
+		r1 &= wrap;
+		if (r1 + n < size) {
+			// contiguous span, the read head does not wrap:
+			const t_sample * m = memory + r1;
+			for (long i = 0; i < n; i++) out[i] = linear_interp(a, m[i], m[i+1]);
+		} else {
+			for (long i = 0; i < n; i++) out[i] = linear_interp(a, memory[(r1+i) & wrap], memory[(r1+i+1) & wrap]);
+		}
+	}
+	
+	inline void read_cubic_block(t_sample d, t_sample * out, long n) {
+		// min 1 sample delay for read before write (r != w)
+		// plus extra 1 sample compensation for 4-point interpolation
+		const t_sample r = t_sample(size + reader) - clamp(d, t_sample(1.)+t_sample(reader != writer), maxdelay);	
+		long r1 = long(r);
+		t_sample a = r - (t_sample)r1;
+		r1 &= wrap;
+		if (r1 + n + 2 < size) {
+			// contiguous span, the read head does not wrap:
+			const t_sample * m = memory + r1;
+			for (long i = 0; i < n; i++) out[i] = cubic_interp(a, m[i], m[i+1], m[i+2], m[i+3]);
+		} else {
+			for (long i = 0; i < n; i++) {
+				out[i] = cubic_interp(a, memory[(r1+i) & wrap], memory[(r1+i+1) & wrap], 
+				                         memory[(r1+i+2) & wrap], memory[(r1+i+3) & wrap]);
+			}
+		}
+	}
+	
+	inline void write_block(const t_sample * in, long n) {
+		long i = 0;
+		while (i < n) {
+			// contiguous span up to the end of the memory:
+			long span = size - reader;
+			if (span > n - i) span = n - i;
+			t_sample * m = memory + reader;
+			for (long j = 0; j < span; j++) m[j] = in[i+j];
+			i += span;
+			writer = reader + span - 1;
+			reader += span;
+			if (reader >= size) reader = 0;
+		}
+	}
 };
 
 template<typename T=t_sample>
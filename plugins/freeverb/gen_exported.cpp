@@ -26,6 +26,8 @@ OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 // global noise generator
 Noise noise;
 static const int GENLIB_LOOPCOUNT_BAIL = 100000;
+// sub-block length of perform(), must not exceed the shortest delay;
+static const int FREEVERB_BLOCK = 128;
 
 
 // The State struct contains all the state and procedures for the gendsp kernel
@@ -89,6 +91,34 @@ typedef struct State {
 		m_delay_24.reset("m_delay_24", 2000);
 		genlib_reset_complete(this);
 		
+	};
+	// lowpass-feedback comb, adds its delay output to sum;
+	inline void comb_block(Delay& delay, t_sample& history, t_sample time, t_sample damp, t_sample rsub, const t_sample * in, t_sample * sum, t_sample * tmp, int n) { 
+		delay.read_linear_block(time, tmp, n);
+		t_sample h = history;
+		for (int i = 0; i < n; i++) { 
+			const t_sample tap = tmp[i];
+			h = ((tap * damp) + (h * rsub));
+			sum[i] = (sum[i] + tap);
+			tmp[i] = (in[i] + (h * m_fb_3));
+			
+		};
+		history = h;
+		delay.write_block(tmp, n);
+		
+	};
+	// schroeder allpass, processes io in place;
+	inline void allpass_block(Delay& delay, t_sample time, t_sample gain, t_sample * io, t_sample * tmp, int n) { 
+		delay.read_linear_block(time, tmp, n);
+		for (int i = 0; i < n; i++) { 
+			const t_sample tap = tmp[i];
+			const t_sample x = io[i];
+			io[i] = (x - tap);
+			tmp[i] = (x + (tap * gain));
+			
+		};
+		delay.write_block(tmp, n);
+		
 	};
 	// the signal processing routine;
 	inline int perform(t_sample ** __ins, t_sample ** __outs, int __n) { 
@@ -132,126 +162,38 @@ typedef struct State {
 		t_sample rsub_520 = (1 - damp_332);
 		t_sample add_445 = (1116 + m_spread_4);
 		t_sample rsub_532 = (1 - damp_333);
-		// the main sample loop;
-		while ((__n--)) { 
-			const t_sample in1 = (*(__in1++));
-			t_sample mul_459 = (in1 * 0.015);
-			t_sample tap_302 = m_delay_5.read_linear(add_439);
-			t_sample gen_410 = tap_302;
-			t_sample mul_300 = (tap_302 * damp_327);
-			t_sample mul_298 = (m_history_6 * rsub_295);
-			t_sample add_299 = (mul_300 + mul_298);
-			t_sample mul_296 = (add_299 * m_fb_3);
-			t_sample add_303 = (mul_459 + mul_296);
-			t_sample history_297_next_304 = add_299;
-			t_sample tap_469 = m_delay_7.read_linear(add_438);
-			t_sample gen_458 = tap_469;
-			t_sample mul_468 = (tap_469 * damp_326);
-			t_sample mul_465 = (m_history_8 * rsub_466);
-			t_sample add_464 = (mul_468 + mul_465);
-			t_sample mul_462 = (add_464 * m_fb_3);
-			t_sample add_463 = (mul_459 + mul_462);
-			t_sample history_297_next_461 = add_464;
-			t_sample tap_474 = m_delay_9.read_linear(add_440);
-			t_sample gen_399 = tap_474;
-			t_sample mul_480 = (tap_474 * damp_328);
-			t_sample mul_478 = (m_history_10 * rsub_479);
-			t_sample add_476 = (mul_480 + mul_478);
-			t_sample mul_473 = (add_476 * m_fb_3);
-			t_sample add_477 = (mul_459 + mul_473);
-			t_sample history_297_next_475 = add_476;
-			t_sample tap_489 = m_delay_11.read_linear(add_441);
-			t_sample gen_388 = tap_489;
-			t_sample mul_493 = (tap_489 * damp_329);
-			t_sample mul_487 = (m_history_12 * rsub_484);
-			t_sample add_492 = (mul_493 + mul_487);
-			t_sample mul_491 = (add_492 * m_fb_3);
-			t_sample add_490 = (mul_459 + mul_491);
-			t_sample history_297_next_485 = add_492;
-			t_sample tap_500 = m_delay_13.read_linear(add_442);
-			t_sample gen_377 = tap_500;
-			t_sample mul_501 = (tap_500 * damp_330);
-			t_sample mul_499 = (m_history_14 * rsub_496);
-			t_sample add_505 = (mul_501 + mul_499);
-			t_sample mul_504 = (add_505 * m_fb_3);
-			t_sample add_503 = (mul_459 + mul_504);
-			t_sample history_297_next_497 = add_505;
-			t_sample tap_512 = m_delay_15.read_linear(add_443);
-			t_sample gen_366 = tap_512;
-			t_sample mul_517 = (tap_512 * damp_331);
-			t_sample mul_511 = (m_history_16 * rsub_508);
-			t_sample add_516 = (mul_517 + mul_511);
-			t_sample mul_513 = (add_516 * m_fb_3);
-			t_sample add_514 = (mul_459 + mul_513);
-			t_sample history_297_next_509 = add_516;
-			t_sample tap_525 = m_delay_17.read_linear(add_444);
-			t_sample gen_355 = tap_525;
-			t_sample mul_521 = (tap_525 * damp_332);
-			t_sample mul_524 = (m_history_18 * rsub_520);
-			t_sample add_529 = (mul_521 + mul_524);
-			t_sample mul_526 = (add_529 * m_fb_3);
-			t_sample add_527 = (mul_459 + mul_526);
-			t_sample history_297_next_522 = add_529;
-			t_sample tap_537 = m_delay_19.read_linear(add_445);
-			t_sample gen_344 = tap_537;
-			t_sample mul_541 = (tap_537 * damp_333);
-			t_sample mul_536 = (m_history_20 * rsub_532);
-			t_sample add_538 = (mul_541 + mul_536);
-			t_sample mul_540 = (add_538 * m_fb_3);
-			t_sample add_534 = (mul_459 + mul_540);
-			t_sample history_297_next_533 = add_538;
-			t_sample add_447 = ((((((((gen_344 + gen_355) + gen_366) + gen_377) + gen_388) + gen_399) + gen_458) + gen_410) + 0);
-			t_sample tap_283 = m_delay_21.read_linear(add_417);
-			t_sample sub_279 = (add_447 - tap_283);
-			t_sample mul_281 = (tap_283 * mul_448);
-			t_sample add_280 = (add_447 + mul_281);
-			t_sample tap_548 = m_delay_22.read_linear(add_446);
-			t_sample sub_546 = (sub_279 - tap_548);
-			t_sample mul_547 = (tap_548 * mul_448);
-			t_sample add_544 = (sub_279 + mul_547);
-			t_sample tap_554 = m_delay_23.read_linear(add_431);
-			t_sample sub_552 = (sub_546 - tap_554);
-			t_sample mul_553 = (tap_554 * mul_448);
-			t_sample add_550 = (sub_546 + mul_553);
-			t_sample tap_560 = m_delay_24.read_linear(add_424);
-			t_sample sub_558 = (sub_552 - tap_560);
-			t_sample mul_559 = (tap_560 * mul_448);
-			t_sample add_556 = (sub_552 + mul_559);
-			t_sample out1 = sub_558;
-			m_delay_5.write(add_303);
-			m_delay_24.write(add_556);
-			m_delay_23.write(add_550);
-			m_delay_22.write(add_544);
-			m_delay_21.write(add_280);
-			m_history_20 = history_297_next_533;
-			m_delay_19.write(add_534);
-			m_history_18 = history_297_next_522;
-			m_delay_17.write(add_527);
-			m_history_16 = history_297_next_509;
-			m_delay_15.write(add_514);
-			m_history_14 = history_297_next_497;
-			m_delay_13.write(add_503);
-			m_history_12 = history_297_next_485;
-			m_delay_11.write(add_490);
-			m_history_10 = history_297_next_475;
-			m_delay_9.write(add_477);
-			m_history_8 = history_297_next_461;
-			m_delay_7.write(add_463);
-			m_history_6 = history_297_next_304;
-			m_delay_5.step();
-			m_delay_7.step();
-			m_delay_9.step();
-			m_delay_11.step();
-			m_delay_13.step();
-			m_delay_15.step();
-			m_delay_17.step();
-			m_delay_19.step();
-			m_delay_21.step();
-			m_delay_22.step();
-			m_delay_23.step();
-			m_delay_24.step();
+		// the graph runs one delay line at a time over sub-blocks, which is the same
+		// as the sample loop as long as no delay is shorter than a sub-block (225 samples);
+		t_sample in_block[FREEVERB_BLOCK];
+		t_sample sum_block[FREEVERB_BLOCK];
+		t_sample tmp_block[FREEVERB_BLOCK];
+		while (__n > 0) { 
+			const int n = (__n < FREEVERB_BLOCK) ? __n : FREEVERB_BLOCK;
+			for (int i = 0; i < n; i++) { 
+				in_block[i] = (__in1[i] * 0.015);
+				sum_block[i] = 0;
+				
+			};
+			comb_block(m_delay_19, m_history_20, add_445, damp_333, rsub_532, in_block, sum_block, tmp_block, n);
+			comb_block(m_delay_17, m_history_18, add_444, damp_332, rsub_520, in_block, sum_block, tmp_block, n);
+			comb_block(m_delay_15, m_history_16, add_443, damp_331, rsub_508, in_block, sum_block, tmp_block, n);
+			comb_block(m_delay_13, m_history_14, add_442, damp_330, rsub_496, in_block, sum_block, tmp_block, n);
+			comb_block(m_delay_11, m_history_12, add_441, damp_329, rsub_484, in_block, sum_block, tmp_block, n);
+			comb_block(m_delay_9, m_history_10, add_440, damp_328, rsub_479, in_block, sum_block, tmp_block, n);
+			comb_block(m_delay_7, m_history_8, add_438, damp_326, rsub_466, in_block, sum_block, tmp_block, n);
+			comb_block(m_delay_5, m_history_6, add_439, damp_327, rsub_295, in_block, sum_block, tmp_block, n);
+			allpass_block(m_delay_21, add_417, mul_448, sum_block, tmp_block, n);
+			allpass_block(m_delay_22, add_446, mul_448, sum_block, tmp_block, n);
+			allpass_block(m_delay_23, add_431, mul_448, sum_block, tmp_block, n);
+			allpass_block(m_delay_24, add_424, mul_448, sum_block, tmp_block, n);
 			// assign results to output buffer;
-			(*(__out1++)) = out1;
+			for (int i = 0; i < n; i++) { 
+				__out1[i] = sum_block[i];
+				
+			};
+			__in1 += n;
+			__out1 += n;
+			__n -= n;
 			
 		};
 		return __exception;
@@ -59,28 +59,55 @@ typedef struct State {
 	t_sample m_history_3;
 	int vectorsize;
 	int __exception;
+	int m_coefficients_dirty;
+	t_sample m_rsub_999;
+	t_sample m_mul_988;
+	t_sample m_expr_1043;
+	t_sample m_mul_990;
+	t_sample m_expr_1045;
+	t_sample m_mul_989;
+	t_sample m_expr_1044;
+	t_sample m_mul_991;
+	t_sample m_expr_1050;
+	t_sample m_mul_934;
+	t_sample m_mul_960;
+	t_sample m_add_914;
+	t_sample m_expr_1046;
+	t_sample m_add_917;
+	t_sample m_expr_1049;
+	t_sample m_add_916;
+	t_sample m_expr_1048;
+	t_sample m_add_915;
+	t_sample m_expr_1047;
+	t_sample m_mul_941;
+	t_sample m_mul_983;
+	t_sample m_mul_967;
+	t_sample m_mul_948;
+	t_sample m_mul_976;
 	// re-initialize all member variables;
 	inline void reset(t_sample __sr, int __vs) {
 		__exception = 0;
 		vectorsize = __vs;
 		samplerate = __sr;
+		// the delay lengths below are in samples at 44100 Hz, grow them for higher rates;
+		t_sample delay_scale = (samplerate > 44100 ? (samplerate / 44100) : 1);
 		m_history_1 = 0;
 		m_history_2 = 0;
 		m_history_3 = 0;
 		m_history_4 = 0;
 		m_history_5 = 0;
-		m_delay_6.reset("m_delay_6", 5000);
-		m_delay_7.reset("m_delay_7", 7000);
-		m_delay_8.reset("m_delay_8", 15000);
-		m_delay_9.reset("m_delay_9", 6000);
-		m_delay_10.reset("m_delay_10", 16000);
-		m_delay_11.reset("m_delay_11", 48000);
-		m_delay_12.reset("m_delay_12", 10000);
-		m_delay_13.reset("m_delay_13", 12000);
-		m_delay_14.reset("m_delay_14", 48000);
-		m_delay_15.reset("m_delay_15", 48000);
-		m_delay_16.reset("m_delay_16", 48000);
-		m_delay_17.reset("m_delay_17", 48000);
+		m_delay_6.reset("m_delay_6", long(ceil(5000 * delay_scale)));
+		m_delay_7.reset("m_delay_7", long(ceil(7000 * delay_scale)));
+		m_delay_8.reset("m_delay_8", long(ceil(15000 * delay_scale)));
+		m_delay_9.reset("m_delay_9", long(ceil(6000 * delay_scale)));
+		m_delay_10.reset("m_delay_10", long(ceil(16000 * delay_scale)));
+		m_delay_11.reset("m_delay_11", long(ceil(48000 * delay_scale)));
+		m_delay_12.reset("m_delay_12", long(ceil(10000 * delay_scale)));
+		m_delay_13.reset("m_delay_13", long(ceil(12000 * delay_scale)));
+		m_delay_14.reset("m_delay_14", long(ceil(48000 * delay_scale)));
+		m_delay_15.reset("m_delay_15", long(ceil(48000 * delay_scale)));
+		m_delay_16.reset("m_delay_16", long(ceil(48000 * delay_scale)));
+		m_delay_17.reset("m_delay_17", long(ceil(48000 * delay_scale)));
 		m_damping_18 = 0.7;
 		m_revtime_19 = 11;
 		m_roomsize_20 = 75;
@@ -89,27 +116,15 @@ typedef struct State {
 		m_tail_23 = 0.25;
 		m_dry_24 = 1;
 		m_early_25 = 0.25;
+		m_coefficients_dirty = 1;
 		genlib_reset_complete(this);
 		
 	};
-	// the signal processing routine;
-	inline int perform(t_sample ** __ins, t_sample ** __outs, int __n) { 
-		vectorsize = __n;
-		const t_sample * __in1 = __ins[0];
-		const t_sample * __in2 = __ins[1];
-		t_sample * __out1 = __outs[0];
-		t_sample * __out2 = __outs[1];
-		if (__exception) { 
-			return __exception;
-			
-		} else if (( (__in1 == 0) || (__in2 == 0) || (__out1 == 0) || (__out2 == 0) )) { 
-			__exception = GENLIB_ERR_NULL_BUFFER;
-			return __exception;
-			
-		};
+	// recompute the coefficients of perform(), only when a parameter or the samplerate changed;
+	inline void update_coefficients() {
 		t_sample rsub_999 = (1 - m_bandwidth_22);
-		t_sample expr_1051 = safepow(0.001, safediv(1, (m_revtime_19 * 44100)));
-		t_sample expr_1052 = safediv((m_roomsize_20 * 44100), 340);
+		t_sample expr_1051 = safepow(0.001, safediv(1, (m_revtime_19 * samplerate)));
+		t_sample expr_1052 = safediv((m_roomsize_20 * samplerate), 340);
 		t_sample mul_988 = (expr_1052 * 0.63245);
 		t_sample expr_1043 = (-safepow(expr_1051, mul_988));
 		t_sample mul_990 = (expr_1052 * 0.81649);
@@ -152,6 +167,76 @@ typedef struct State {
 		t_sample mul_948 = (int_984 * add_926);
 		t_sample add_968 = (mul_969 + 159);
 		t_sample mul_976 = (int_984 * add_968);
+		m_rsub_999 = rsub_999;
+		m_mul_988 = mul_988;
+		m_expr_1043 = expr_1043;
+		m_mul_990 = mul_990;
+		m_expr_1045 = expr_1045;
+		m_mul_989 = mul_989;
+		m_expr_1044 = expr_1044;
+		m_mul_991 = mul_991;
+		m_expr_1050 = expr_1050;
+		m_mul_934 = mul_934;
+		m_mul_960 = mul_960;
+		m_add_914 = add_914;
+		m_expr_1046 = expr_1046;
+		m_add_917 = add_917;
+		m_expr_1049 = expr_1049;
+		m_add_916 = add_916;
+		m_expr_1048 = expr_1048;
+		m_add_915 = add_915;
+		m_expr_1047 = expr_1047;
+		m_mul_941 = mul_941;
+		m_mul_983 = mul_983;
+		m_mul_967 = mul_967;
+		m_mul_948 = mul_948;
+		m_mul_976 = mul_976;
+		m_coefficients_dirty = 0;
+		
+	};
+	// the signal processing routine;
+	inline int perform(t_sample ** __ins, t_sample ** __outs, int __n) { 
+		vectorsize = __n;
+		const t_sample * __in1 = __ins[0];
+		const t_sample * __in2 = __ins[1];
+		t_sample * __out1 = __outs[0];
+		t_sample * __out2 = __outs[1];
+		if (__exception) { 
+			return __exception;
+			
+		} else if (( (__in1 == 0) || (__in2 == 0) || (__out1 == 0) || (__out2 == 0) )) { 
+			__exception = GENLIB_ERR_NULL_BUFFER;
+			return __exception;
+			
+		};
+		if (m_coefficients_dirty) {
+			update_coefficients();
+			
+		};
+		const t_sample rsub_999 = m_rsub_999;
+		const t_sample mul_988 = m_mul_988;
+		const t_sample expr_1043 = m_expr_1043;
+		const t_sample mul_990 = m_mul_990;
+		const t_sample expr_1045 = m_expr_1045;
+		const t_sample mul_989 = m_mul_989;
+		const t_sample expr_1044 = m_expr_1044;
+		const t_sample mul_991 = m_mul_991;
+		const t_sample expr_1050 = m_expr_1050;
+		const t_sample mul_934 = m_mul_934;
+		const t_sample mul_960 = m_mul_960;
+		const t_sample add_914 = m_add_914;
+		const t_sample expr_1046 = m_expr_1046;
+		const t_sample add_917 = m_add_917;
+		const t_sample expr_1049 = m_expr_1049;
+		const t_sample add_916 = m_add_916;
+		const t_sample expr_1048 = m_expr_1048;
+		const t_sample add_915 = m_add_915;
+		const t_sample expr_1047 = m_expr_1047;
+		const t_sample mul_941 = m_mul_941;
+		const t_sample mul_983 = m_mul_983;
+		const t_sample mul_967 = m_mul_967;
+		const t_sample mul_948 = m_mul_948;
+		const t_sample mul_976 = m_mul_976;
 		// the main sample loop;
 		while ((__n--)) { 
 			const t_sample in1 = (*(__in1++));
@@ -303,15 +388,19 @@ typedef struct State {
 	};
 	inline void set_revtime(t_sample _value) {
 		m_revtime_19 = (_value < 0.1 ? 0.1 : (_value > 360 ? 360 : _value));
+		m_coefficients_dirty = 1;
 	};
 	inline void set_roomsize(t_sample _value) {
 		m_roomsize_20 = (_value < 0.1 ? 0.1 : (_value > 300 ? 300 : _value));
+		m_coefficients_dirty = 1;
 	};
 	inline void set_spread(t_sample _value) {
 		m_spread_21 = (_value < 0 ? 0 : (_value > 100 ? 100 : _value));
+		m_coefficients_dirty = 1;
 	};
 	inline void set_bandwidth(t_sample _value) {
 		m_bandwidth_22 = (_value < 0 ? 0 : (_value > 1 ? 1 : _value));
+		m_coefficients_dirty = 1;
 	};
 	inline void set_tail(t_sample _value) {
 		m_tail_23 = (_value < 0 ? 0 : (_value > 1 ? 1 : _value));
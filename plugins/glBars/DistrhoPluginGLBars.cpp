@@ -20,16 +20,20 @@
 
 #include "DistrhoPluginGLBars.hpp"
 
-#include "glBars.hpp"
-
 START_NAMESPACE_DISTRHO
 
 // -----------------------------------------------------------------------
 
+// size of the audio ring buffer, in samples, enough for a few frames worth of audio
+static constexpr const uint32_t kRingBufferSize = 16384;
+
+// -----------------------------------------------------------------------
+
 DistrhoPluginGLBars::DistrhoPluginGLBars()
-    : Plugin(kParameterCount, 0, 0),
-      fState(nullptr)
+    : Plugin(kParameterCount, 0, 0)
 {
+    fRingBuffer.createBuffer(kRingBufferSize * sizeof(float));
+
     fParameters[kParameterScale] = 1.f / log(256.f);
     fParameters[kParameterSpeed] = 0.025f;
     fParameters[kParameterX]     = 0.0f;
@@ -39,7 +43,6 @@ DistrhoPluginGLBars::DistrhoPluginGLBars()
 
 DistrhoPluginGLBars::~DistrhoPluginGLBars()
 {
-    DISTRHO_SAFE_ASSERT(fState == nullptr);
 }
 
 // -----------------------------------------------------------------------
@@ -138,10 +141,19 @@ void DistrhoPluginGLBars::run(const float** inputs, float** outputs, uint32_t fr
     if (out != in)
         std::memcpy(out, in, sizeof(float)*frames);
 
-    const MutexLocker csm(fMutex);
+    // only the most recent audio matters for the analyzer
+    if (frames >= kRingBufferSize / 2)
+    {
+        in += frames - kRingBufferSize / 2;
+        frames = kRingBufferSize / 2;
+    }
+
+    // drop audio instead of waiting if the UI is not reading (closed or too slow)
+    if (fRingBuffer.getWritableDataSize() <= sizeof(float)*frames)
+        return;
 
-    if (fState != nullptr)
-        fState->AudioData(in, frames);
+    fRingBuffer.writeCustomData(in, sizeof(float)*frames);
+    fRingBuffer.commitWrite();
 }
 
 // -----------------------------------------------------------------------
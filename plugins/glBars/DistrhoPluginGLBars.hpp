@@ -22,10 +22,9 @@
 #define DISTRHO_PLUGIN_GLBARS_HPP_INCLUDED
 
 #include "DistrhoPlugin.hpp"
-#include "extra/Mutex.hpp"
+#include "extra/RingBuffer.hpp"
 
 class DistrhoUIGLBars;
-struct glBarsState;
 
 START_NAMESPACE_DISTRHO
 
@@ -96,8 +95,8 @@ protected:
     // -------------------------------------------------------------------
 
 private:
-    Mutex fMutex;
-    glBarsState* fState;
+    // audio thread writes, UI thread reads and analyzes right before drawing
+    HeapRingBuffer fRingBuffer;
     float fParameters[kParameterCount];
     friend class DistrhoUIGLBars;
 
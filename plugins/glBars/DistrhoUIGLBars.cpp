@@ -27,9 +27,10 @@ START_NAMESPACE_DISTRHO
 
 DistrhoUIGLBars::DistrhoUIGLBars()
     : UI(512, 512),
-      fInitialized(false),
       fResizeHandle(this)
 {
+    fState.setSampleRate(getSampleRate());
+
     const double scaleFactor = getScaleFactor();
 
     if (d_isNotZero(scaleFactor))
@@ -44,14 +45,6 @@ DistrhoUIGLBars::DistrhoUIGLBars()
 
 DistrhoUIGLBars::~DistrhoUIGLBars()
 {
-    if (! fInitialized)
-        return;
-
-    if (DistrhoPluginGLBars* const dspPtr = (DistrhoPluginGLBars*)getPluginInstancePointer())
-    {
-        const MutexLocker csm(dspPtr->fMutex);
-        dspPtr->fState = nullptr;
-    }
 }
 
 // -----------------------------------------------------------------------
@@ -86,20 +79,14 @@ void DistrhoUIGLBars::parameterChanged(uint32_t index, float value)
 // -----------------------------------------------------------------------
 // UI Callbacks
 
+void DistrhoUIGLBars::sampleRateChanged(double newSampleRate)
+{
+    fState.setSampleRate(newSampleRate);
+}
+
 void DistrhoUIGLBars::uiIdle()
 {
     repaint();
-
-    if (DistrhoPluginGLBars* const dspPtr = (DistrhoPluginGLBars*)getPluginInstancePointer())
-    {
-        if (dspPtr->fState != nullptr)
-            return;
-
-        fInitialized = true;
-
-        const MutexLocker csm(dspPtr->fMutex);
-        dspPtr->fState = &fState;
-    }
 }
 
 // -----------------------------------------------------------------------
@@ -107,6 +94,23 @@ void DistrhoUIGLBars::uiIdle()
 
 void DistrhoUIGLBars::onDisplay()
 {
+    // analyze all audio received since the last frame
+    if (DistrhoPluginGLBars* const dspPtr = (DistrhoPluginGLBars*)getPluginInstancePointer())
+    {
+        HeapRingBuffer& ringBuffer(dspPtr->fRingBuffer);
+        float buffer[512];
+
+        while (ringBuffer.isDataAvailableForReading())
+        {
+            const uint32_t size = std::min<uint32_t>(ringBuffer.getReadableDataSize(), sizeof(buffer));
+
+            if (! ringBuffer.readCustomData(buffer, size))
+                break;
+
+            fState.AudioData(buffer, size / sizeof(float));
+        }
+    }
+
     fState.Render();
 }
 
@@ -45,6 +45,7 @@ protected:
     // -------------------------------------------------------------------
     // UI Callbacks
 
+    void sampleRateChanged(double newSampleRate) override;
     void uiIdle() override;
 
     // -------------------------------------------------------------------
@@ -53,7 +54,6 @@ protected:
     void onDisplay() override;
 
 private:
-    bool fInitialized;
     glBarsState fState;
     ResizeHandle fResizeHandle;
 
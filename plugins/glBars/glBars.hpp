@@ -22,6 +22,10 @@
 
 #include "OpenGL.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 static inline
 void draw_rectangle(GLfloat x1, GLfloat y1, GLfloat z1, GLfloat x2, GLfloat y2, GLfloat z2)
 {
@@ -78,6 +82,16 @@ void draw_bar(GLenum mode, GLfloat x_offset, GLfloat z_offset, GLfloat height, G
 }
 
 struct glBarsState {
+    // analysis window, about 43ms at 48kHz
+    static const int kFFTSize = 2048;
+    // new rows of bars per second of audio, whatever the host buffer size
+    static const int kRowsPerSecond = 60;
+    // time for a band to fall to 1/e of its level, in seconds
+    static constexpr const float kBandDecayTime = 0.08f;
+    // band edges, the top one is limited to nyquist
+    static constexpr const float kLowestFrequency = 40.f;
+    static constexpr const float kHighestFrequency = 16000.f;
+
     GLenum g_mode;
     GLfloat x_angle, x_speed;
     GLfloat y_angle, y_speed;
@@ -85,6 +99,18 @@ struct glBarsState {
     GLfloat heights[16][16], cHeights[16][16], scale;
     GLfloat hSpeed;
 
+    // spectrum analysis, fed from the UI thread
+    double sampleRate;
+    int hopSize, hopPos;
+    int historyPos;
+    int bandStart[17];
+    float bandDecay, windowGain;
+    float bands[16];
+    float history[kFFTSize];
+    float window[kFFTSize];
+    float fftReal[kFFTSize], fftImag[kFFTSize];
+    float twiddleCos[kFFTSize / 2], twiddleSin[kFFTSize / 2];
+
     glBarsState()
     {
         g_mode = GL_FILL;
@@ -114,6 +140,46 @@ struct glBarsState {
             for (int y = 0; y < 16; y++)
                 cHeights[y][x] = heights[y][x] = 0;
         }
+
+        // hann window, magnitudes are normalized so that a full scale sine reads 1.0
+        windowGain = 0.f;
+        for (int i = 0; i < kFFTSize; i++)
+        {
+            window[i] = 0.5f - 0.5f * std::cos(2.0 * M_PI * i / kFFTSize);
+            windowGain += window[i];
+        }
+        windowGain = 2.f / windowGain;
+
+        for (int i = 0; i < kFFTSize / 2; i++)
+        {
+            twiddleCos[i] = std::cos(2.0 * M_PI * i / kFFTSize);
+            twiddleSin[i] = -std::sin(2.0 * M_PI * i / kFFTSize);
+        }
+
+        std::memset(history, 0, sizeof(history));
+        std::memset(bands, 0, sizeof(bands));
+        historyPos = hopPos = 0;
+
+        setSampleRate(44100.0);
+    }
+
+    void setSampleRate(const double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        hopSize = std::max(1, int(sampleRate / kRowsPerSecond + 0.5));
+        bandDecay = std::exp(-1.f / (kRowsPerSecond * kBandDecayTime));
+
+        // log spaced bands, each one at least one bin wide
+        const double binWidth = sampleRate / kFFTSize;
+        const double highest = std::min<double>(kHighestFrequency, sampleRate * 0.5);
+        const double ratio = std::pow(highest / kLowestFrequency, 1.0 / 16);
+
+        bandStart[0] = std::max(1, int(kLowestFrequency / binWidth));
+        for (int i = 1; i <= 16; i++)
+        {
+            const int bin = int(kLowestFrequency * std::pow(ratio, i) / binWidth + 0.5);
+            bandStart[i] = std::min(kFFTSize / 2, std::max(bandStart[i - 1] + 1, bin));
+        }
     }
 
     void drawBars()
@@ -194,39 +260,84 @@ struct glBarsState {
         glEnable(GL_BLEND);
     }
 
+    // appends audio to the analysis window, adding a row of bars every hopSize samples
     void AudioData(const float* pAudioData, int iAudioDataLength)
     {
-        const int xscale[] = {0, 1, 2, 3, 5, 7, 10, 14, 20, 28, 40, 54, 74, 101, 137, 187, 255};
+        while (iAudioDataLength > 0)
+        {
+            const int count = std::min(iAudioDataLength, std::min(hopSize - hopPos, kFFTSize - historyPos));
 
-        GLfloat val;
+            std::memcpy(history + historyPos, pAudioData, sizeof(float)*count);
+            pAudioData += count;
+            iAudioDataLength -= count;
 
-        for (int y = 15; y > 0; y--)
+            historyPos = (historyPos + count) % kFFTSize;
+            hopPos += count;
+
+            if (hopPos == hopSize)
+            {
+                hopPos = 0;
+                analyze();
+            }
+        }
+    }
+
+    void analyze()
+    {
+        // windowed copy of the latest kFFTSize samples, oldest first, in bit reversed order
+        for (int i = 0, j = 0; i < kFFTSize; i++)
         {
-            for (int i = 0; i < 16; i++)
-                heights[y][i] = heights[y - 1][i];
+            fftReal[j] = history[(historyPos + i) % kFFTSize] * window[i];
+            fftImag[j] = 0.f;
+
+            int bit = kFFTSize >> 1;
+            for (; j & bit; bit >>= 1)
+                j ^= bit;
+            j |= bit;
         }
 
-        for (int i = 0; i < 16; i++)
+        // in-place radix-2
+        for (int size = 2; size <= kFFTSize; size <<= 1)
         {
-            int y = 0;
-            for (int c = xscale[i]; c < xscale[i + 1]; c++)
+            const int half = size >> 1;
+            const int step = kFFTSize / size;
+
+            for (int start = 0; start < kFFTSize; start += size)
             {
-                if (c<iAudioDataLength)
+                for (int k = 0; k < half; k++)
                 {
-                    if ((int)(pAudioData[c] * (INT16_MAX)) > y)
-                        y = (int)(pAudioData[c] * (INT16_MAX));
-                }
-                else
-                {
-                    continue;
+                    const float wr = twiddleCos[k * step];
+                    const float wi = twiddleSin[k * step];
+                    const int a = start + k;
+                    const int b = a + half;
+                    const float tr = fftReal[b] * wr - fftImag[b] * wi;
+                    const float ti = fftReal[b] * wi + fftImag[b] * wr;
+
+                    fftReal[b] = fftReal[a] - tr;
+                    fftImag[b] = fftImag[a] - ti;
+                    fftReal[a] += tr;
+                    fftImag[a] += ti;
                 }
             }
-            y >>= 7;
-            if (y > 0)
-                val = (logf(y) * scale);
-            else
-                val = 0;
-            heights[0][i] = val;
+        }
+
+        for (int y = 15; y > 0; y--)
+        {
+            for (int i = 0; i < 16; i++)
+                heights[y][i] = heights[y - 1][i];
+        }
+
+        for (int i = 0; i < 16; i++)
+        {
+            float peak = 0.f;
+            for (int c = bandStart[i]; c < bandStart[i + 1]; c++)
+                peak = std::max(peak, fftReal[c] * fftReal[c] + fftImag[c] * fftImag[c]);
+
+            bands[i] = std::max(std::sqrt(peak) * windowGain, bands[i] * bandDecay);
+
+            // same 8 bit range as the original plugin, which used the peak sample value
+            const float y = bands[i] * 256.f;
+            heights[0][i] = y > 1.f ? std::log(y) * scale : 0.f;
         }
     }
 };